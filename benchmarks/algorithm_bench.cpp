@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "emlabcpp/algorithm.h"
+
+using namespace emlabcpp;
+
+namespace
+{
+
+constexpr std::size_t data_size = 1024;
+
+std::vector< float > make_floats()
+{
+        std::vector< float > res( data_size );
+        for ( std::size_t i = 0; i < res.size(); i++ ) {
+                res[i] = static_cast< float >( ( i * 7919 ) % 1000 ) * 0.01f;
+        }
+        return res;
+}
+
+std::array< int32_t, data_size > make_ints()
+{
+        std::array< int32_t, data_size > res{};
+        for ( std::size_t i = 0; i < res.size(); i++ ) {
+                res[i] = static_cast< int32_t >( ( i * 7919 ) % 1000 ) - 500;
+        }
+        return res;
+}
+
+void algorithm_sum_float( bench_state& state )
+{
+        auto data = make_floats();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                bench_do_not_optimize( sum( data ) );
+        } );
+}
+
+void algorithm_sum_int( bench_state& state )
+{
+        auto data = make_ints();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                bench_do_not_optimize( sum( data ) );
+        } );
+}
+
+void algorithm_avg_float( bench_state& state )
+{
+        auto data = make_floats();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                bench_do_not_optimize( avg( data ) );
+        } );
+}
+
+void algorithm_variance_float( bench_state& state )
+{
+        auto data = make_floats();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                bench_do_not_optimize( variance( data ) );
+        } );
+}
+
+void algorithm_min_max_elem_int( bench_state& state )
+{
+        auto data = make_ints();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                auto res = min_max_elem( data );
+                bench_do_not_optimize( res );
+        } );
+}
+
+void algorithm_count_int( bench_state& state )
+{
+        auto data = make_ints();
+        state.set_items_per_op( data.size() );
+        state.run( [&] {
+                bench_do_not_optimize( count( data, []( int32_t v ) {
+                        return v > 0;
+                } ) );
+        } );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "algorithm_sum_float", &algorithm_sum_float );
+        register_bench( "algorithm_sum_int", &algorithm_sum_int );
+        register_bench( "algorithm_avg_float", &algorithm_avg_float );
+        register_bench( "algorithm_variance_float", &algorithm_variance_float );
+        register_bench( "algorithm_min_max_elem_int", &algorithm_min_max_elem_int );
+        register_bench( "algorithm_count_int", &algorithm_count_int );
+}
+
+}  // namespace
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "emlabcpp/allocator/pool.h"
+#include "emlabcpp/static_circular_buffer.h"
+
+using namespace emlabcpp;
+
+namespace
+{
+
+void static_circular_buffer_push_pop( bench_state& state )
+{
+        static_circular_buffer< uint32_t, 64 > buff;
+        state.set_items_per_op( 32 );
+        state.run( [&] {
+                for ( uint32_t i = 0; i < 32; i++ ) {
+                        buff.push_back( i );
+                }
+                while ( !buff.empty() ) {
+                        bench_do_not_optimize( buff.take_front() );
+                }
+        } );
+}
+
+void static_circular_buffer_interleaved( bench_state& state )
+{
+        static_circular_buffer< uint32_t, 64 > buff;
+        for ( uint32_t i = 0; i < 32; i++ ) {
+                buff.push_back( i );
+        }
+        state.set_items_per_op( 1 );
+        uint32_t i = 0;
+        state.run( [&] {
+                buff.push_back( i++ );
+                bench_do_not_optimize( buff.take_front() );
+        } );
+}
+
+void pool_resource_allocate_deallocate( bench_state& state )
+{
+        pool_resource< 64, 32 >   pool;
+        std::array< void*, 32 >   ptrs{};
+        state.set_items_per_op( ptrs.size() );
+        state.run( [&] {
+                for ( void*& p : ptrs ) {
+                        p = pool.allocate( 48 );
+                }
+                for ( void* p : ptrs ) {
+                        pool.deallocate( p );
+                }
+                bench_do_not_optimize( ptrs );
+        } );
+}
+
+void pool_vector_push_back( bench_state& state )
+{
+        pool_resource< 512, 4 > pool;
+        state.set_items_per_op( 64 );
+        state.run( [&] {
+                pool_vector< uint32_t > vec{ pool_allocator< uint32_t >{ &pool } };
+                vec.reserve( 64 );
+                for ( uint32_t i = 0; i < 64; i++ ) {
+                        vec.push_back( i );
+                }
+                bench_do_not_optimize( vec.back() );
+        } );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "static_circular_buffer_push_pop", &static_circular_buffer_push_pop );
+        register_bench( "static_circular_buffer_interleaved", &static_circular_buffer_interleaved );
+        register_bench( "pool_resource_allocate_deallocate", &pool_resource_allocate_deallocate );
+        register_bench( "pool_vector_push_back", &pool_vector_push_back );
+}
+
+}  // namespace
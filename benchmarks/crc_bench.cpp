@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "emlabcpp/crc.h"
+
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+// Bit by bit CRC-32C, as a baseline for the table driven implementation
+uint32_t bitwise_crc32c( view< const uint8_t* > data )
+{
+        uint32_t reg = 0xFFFFFFFF;
+        for ( uint8_t byte : data ) {
+                reg ^= byte;
+                for ( std::size_t i = 0; i < 8; i++ ) {
+                        reg = ( reg & 1 ) ? ( reg >> 1 ) ^ 0x82F63B78 : ( reg >> 1 );
+                }
+        }
+        return reg ^ 0xFFFFFFFF;
+}
+
+template < auto F >
+void bench_checksum( bench_state& state, std::size_t size )
+{
+        std::vector< uint8_t > data( size );
+        for ( std::size_t i = 0; i < size; i++ ) {
+                data[i] = static_cast< uint8_t >( i * 7 );
+        }
+        state.set_bytes_per_op( size );
+        state.run( [&] {
+                bench_clobber_memory();
+                auto res = F( view_n( data.data(), data.size() ) );
+                bench_do_not_optimize( res );
+        } );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "crc/bitwise_crc32c/1024", []( bench_state& state ) {
+                bench_checksum< bitwise_crc32c >( state, 1024 );
+        } );
+        register_bench( "crc/crc8/1024", []( bench_state& state ) {
+                bench_checksum< crc8::compute >( state, 1024 );
+        } );
+        register_bench( "crc/crc16_ccitt/1024", []( bench_state& state ) {
+                bench_checksum< crc16_ccitt::compute >( state, 1024 );
+        } );
+        register_bench( "crc/crc32/1024", []( bench_state& state ) {
+                bench_checksum< crc32::compute >( state, 1024 );
+        } );
+        register_bench( "crc/crc32c/1024", []( bench_state& state ) {
+                bench_checksum< crc32c::compute >( state, 1024 );
+        } );
+        register_bench( "crc/crc32c/64", []( bench_state& state ) {
+                bench_checksum< crc32c::compute >( state, 64 );
+        } );
+}
+
+}  // namespace
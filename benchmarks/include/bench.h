@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Minimal self-contained micro-benchmark harness. Each benchmark is a function that prepares its
+// data and passes the measured operation to `bench_state::run`, which executes it in a calibrated
+// loop. Only the loop itself is measured.
+
+// Prevents compiler from optimizing away computation of `val`.
+template < typename T >
+inline void bench_do_not_optimize( const T& val )
+{
+        asm volatile( "" : : "r,m"( val ) : "memory" );
+}
+
+// Forces compiler to assume that all memory was read and written.
+inline void bench_clobber_memory()
+{
+        asm volatile( "" : : : "memory" );
+}
+
+struct bench_config
+{
+        std::chrono::nanoseconds min_time    = std::chrono::milliseconds( 100 );
+        std::size_t              repetitions = 5;
+};
+
+struct bench_result
+{
+        std::string name;
+        std::size_t iterations  = 0;
+        std::size_t repetitions = 0;
+        double      ns_min      = 0;
+        double      ns_median   = 0;
+        double      ns_mean     = 0;
+        // items and bytes processed by one execution of the measured operation, zero if not set
+        std::size_t items_per_op = 0;
+        std::size_t bytes_per_op = 0;
+};
+
+class bench_state
+{
+public:
+        bench_state( std::string name, const bench_config& conf )
+          : conf_( conf )
+        {
+                res_.name = std::move( name );
+        }
+
+        void set_items_per_op( std::size_t n )
+        {
+                res_.items_per_op = n;
+        }
+
+        void set_bytes_per_op( std::size_t n )
+        {
+                res_.bytes_per_op = n;
+        }
+
+        // Executes `f` repeatedly, the number of iterations is selected so that one repetition
+        // takes at least `min_time`. Stores time of one execution of `f` from each repetition.
+        template < typename NullFunction >
+        void run( NullFunction&& f )
+        {
+                std::size_t              iterations = 1;
+                std::chrono::nanoseconds t          = measure( f, iterations );
+                while ( t < conf_.min_time && iterations < max_iterations ) {
+                        double ratio = t.count() == 0 ? 10. :
+                                                        1.2 * static_cast< double >(
+                                                                  conf_.min_time.count() ) /
+                                                            static_cast< double >( t.count() );
+                        ratio        = std::clamp( ratio, 1.5, 10. );
+                        iterations   = static_cast< std::size_t >(
+                            static_cast< double >( iterations ) * ratio );
+                        t = measure( f, iterations );
+                }
+
+                std::vector< double > samples;
+                for ( std::size_t i = 0; i < conf_.repetitions; i++ ) {
+                        samples.push_back(
+                            static_cast< double >( measure( f, iterations ).count() ) /
+                            static_cast< double >( iterations ) );
+                }
+                std::sort( samples.begin(), samples.end() );
+
+                res_.iterations  = iterations;
+                res_.repetitions = samples.size();
+                res_.ns_min      = samples.front();
+                res_.ns_median   = samples[samples.size() / 2];
+                double sum       = 0;
+                for ( double s : samples ) {
+                        sum += s;
+                }
+                res_.ns_mean = sum / static_cast< double >( samples.size() );
+        }
+
+        [[nodiscard]] const bench_result& result() const
+        {
+                return res_;
+        }
+
+private:
+        static constexpr std::size_t max_iterations = 1'000'000'000;
+
+        template < typename NullFunction >
+        static std::chrono::nanoseconds measure( NullFunction& f, std::size_t iterations )
+        {
+                auto start = std::chrono::steady_clock::now();
+                for ( std::size_t i = 0; i < iterations; i++ ) {
+                        f();
+                        bench_clobber_memory();
+                }
+                auto end = std::chrono::steady_clock::now();
+                return std::chrono::duration_cast< std::chrono::nanoseconds >( end - start );
+        }
+
+        const bench_config& conf_;
+        bench_result        res_;
+};
+
+using bench_function = std::function< void( bench_state& ) >;
+
+struct bench_entry
+{
+        std::string    name;
+        bench_function f;
+};
+
+inline std::vector< bench_entry >& bench_registry()
+{
+        static std::vector< bench_entry > reg;
+        return reg;
+}
+
+inline bool register_bench( std::string name, bench_function f )
+{
+        bench_registry().push_back( bench_entry{ std::move( name ), std::move( f ) } );
+        return true;
+}
+
+}  // namespace emlabcpp
+
+// Defines function that registers the benchmarks of the file during static initialization, its body
+// calls `register_bench` for each of them:
+//
+// EMLABCPP_REGISTER_BENCHMARKS()
+// {
+//         register_bench( "group/name", &bench_function );
+// }
+#define EMLABCPP_REGISTER_BENCHMARKS()                                                         \
+        static void emlabcpp_register_benchmarks();                                            \
+        [[maybe_unused]] static const bool emlabcpp_benchmarks_registered =                    \
+            ( emlabcpp_register_benchmarks(), true );                                          \
+        static void emlabcpp_register_benchmarks()
@@ -0,0 +1,146 @@
+#include "bench.h"
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+void print_usage( std::ostream& os )
+{
+        os << "usage: emlabcpp_benchmarks [--filter=<substr>] [--out=<file.json>]\n"
+              "                           [--min-time-ms=<n>] [--repetitions=<n>]\n";
+}
+
+std::string json_escape( const std::string& s )
+{
+        std::string res;
+        for ( char c : s ) {
+                if ( c == '"' || c == '\\' ) {
+                        res += '\\';
+                }
+                res += c;
+        }
+        return res;
+}
+
+double per_second( std::size_t count, double ns_per_op )
+{
+        if ( ns_per_op == 0 ) {
+                return 0;
+        }
+        return static_cast< double >( count ) * 1e9 / ns_per_op;
+}
+
+// Output follows the shape of google benchmark json output, so existing tools for comparison of
+// results can be used.
+void write_json( std::ostream& os, const std::vector< bench_result >& results )
+{
+        std::time_t now = std::time( nullptr );
+        os << "{\n";
+        os << "  \"context\": {\n";
+        os << "    \"date\": \"" << std::put_time( std::gmtime( &now ), "%FT%TZ" ) << "\",\n";
+        os << "    \"library\": \"emlabcpp\",\n";
+#ifdef NDEBUG
+        os << "    \"library_build_type\": \"release\"\n";
+#else
+        os << "    \"library_build_type\": \"debug\"\n";
+#endif
+        os << "  },\n";
+        os << "  \"benchmarks\": [";
+        for ( std::size_t i = 0; i < results.size(); i++ ) {
+                const bench_result& r = results[i];
+                os << ( i == 0 ? "\n" : ",\n" );
+                os << "    {\n";
+                os << "      \"name\": \"" << json_escape( r.name ) << "\",\n";
+                os << "      \"iterations\": " << r.iterations << ",\n";
+                os << "      \"repetitions\": " << r.repetitions << ",\n";
+                os << "      \"real_time\": " << r.ns_median << ",\n";
+                os << "      \"min_time\": " << r.ns_min << ",\n";
+                os << "      \"mean_time\": " << r.ns_mean << ",\n";
+                os << "      \"time_unit\": \"ns\"";
+                if ( r.items_per_op != 0 ) {
+                        os << ",\n      \"items_per_second\": "
+                           << per_second( r.items_per_op, r.ns_median );
+                }
+                if ( r.bytes_per_op != 0 ) {
+                        os << ",\n      \"bytes_per_second\": "
+                           << per_second( r.bytes_per_op, r.ns_median );
+                }
+                os << "\n    }";
+        }
+        os << "\n  ]\n}\n";
+}
+
+void write_row( std::ostream& os, const bench_result& r )
+{
+        os << std::left << std::setw( 48 ) << r.name << std::right << std::setw( 14 )
+           << std::fixed << std::setprecision( 2 ) << r.ns_median << " ns" << std::setw( 14 )
+           << r.iterations;
+        if ( r.bytes_per_op != 0 ) {
+                os << std::setw( 12 ) << per_second( r.bytes_per_op, r.ns_median ) / 1e6
+                   << " MB/s";
+        } else if ( r.items_per_op != 0 ) {
+                os << std::setw( 12 ) << per_second( r.items_per_op, r.ns_median ) / 1e6
+                   << " M/s";
+        }
+        os << "\n";
+}
+
+}  // namespace
+
+int main( int argc, char** argv )
+{
+        bench_config conf;
+        std::string  filter;
+        std::string  out_file;
+
+        for ( int i = 1; i < argc; i++ ) {
+                std::string arg = argv[i];
+                auto        val = [&]( const char* key ) -> std::optional< std::string > {
+                        std::size_t n = std::strlen( key );
+                        if ( arg.compare( 0, n, key ) != 0 ) {
+                                return {};
+                        }
+                        return arg.substr( n );
+                };
+                if ( auto v = val( "--filter=" ) ) {
+                        filter = *v;
+                } else if ( auto v = val( "--out=" ) ) {
+                        out_file = *v;
+                } else if ( auto v = val( "--min-time-ms=" ) ) {
+                        conf.min_time = std::chrono::milliseconds( std::stoul( *v ) );
+                } else if ( auto v = val( "--repetitions=" ) ) {
+                        conf.repetitions = std::max( std::stoul( *v ), 1ul );
+                } else {
+                        print_usage( std::cerr );
+                        return 1;
+                }
+        }
+
+        std::vector< bench_result > results;
+        for ( const bench_entry& e : bench_registry() ) {
+                if ( e.name.find( filter ) == std::string::npos ) {
+                        continue;
+                }
+                bench_state state{ e.name, conf };
+                e.f( state );
+                results.push_back( state.result() );
+                write_row( std::cerr, results.back() );
+        }
+
+        if ( out_file.empty() ) {
+                write_json( std::cout, results );
+                return 0;
+        }
+
+        std::ofstream ofs{ out_file };
+        write_json( ofs, results );
+        return ofs.good() ? 0 : 1;
+}
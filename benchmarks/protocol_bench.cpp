@@ -0,0 +1,408 @@
+#include "bench.h"
+#include "emlabcpp/protocol/command_group.h"
+#include "emlabcpp/protocol/dispatcher.h"
+#include "emlabcpp/protocol/handler.h"
+#include "emlabcpp/protocol/tuple.h"
+#include "emlabcpp/visit.h"
+
+#include <string>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+// Telemetry-like record of fixed size
+using record_tuple = protocol_tuple<
+    PROTOCOL_BIG_ENDIAN,
+    uint32_t,
+    uint16_t,
+    std::array< uint16_t, 16 >,
+    int32_t,
+    float,
+    std::bitset< 12 > >;
+
+using record_variant = std::variant<
+    uint32_t,
+    std::tuple< uint16_t, uint16_t >,
+    std::array< uint8_t, 12 >,
+    int64_t,
+    std::tuple< uint8_t, uint32_t, uint8_t > >;
+
+enum bench_cmd_ids : uint8_t
+{
+        BC_RESET  = 0,
+        BC_SET    = 3,
+        BC_GET    = 7,
+        BC_MOVE   = 12,
+        BC_CONFIG = 42,
+        BC_STREAM = 99,
+};
+
+struct record_group
+  : protocol_command_group< PROTOCOL_BIG_ENDIAN >::with_commands<
+        protocol_command< BC_RESET >,
+        protocol_command< BC_SET >::with_args< uint16_t, uint32_t >,
+        protocol_command< BC_GET >::with_args< uint16_t >,
+        protocol_command< BC_MOVE >::with_args< int32_t, int32_t, int32_t, uint16_t >,
+        protocol_command< BC_CONFIG >::with_args< std::array< uint32_t, 8 >, uint8_t >,
+        protocol_command< BC_STREAM >::with_args< uint32_t, protocol_sizeless_message< 32 > > >
+{
+};
+
+template < typename T >
+void bench_serialize( bench_state& state, typename protocol_handler< T >::value_type val )
+{
+        using handler = protocol_handler< T >;
+        state.set_bytes_per_op( handler::serialize( val ).size() );
+        state.run( [&] {
+                auto msg = handler::serialize( val );
+                bench_do_not_optimize( msg );
+        } );
+}
+
+template < typename T >
+void bench_serialize_into( bench_state& state, typename protocol_handler< T >::value_type val )
+{
+        using handler = protocol_handler< T >;
+        std::array< uint8_t, handler::def::max_size > buffer;
+        state.set_bytes_per_op( *handler::serialize_into( buffer, val ) );
+        state.run( [&] {
+                auto used = handler::serialize_into( buffer, val );
+                bench_do_not_optimize( used );
+                bench_do_not_optimize( buffer );
+        } );
+}
+
+// Serializes into the end of a vector through std::back_inserter, the vector is cleared but keeps
+// its capacity between the runs
+template < typename T >
+void bench_serialize_iterator( bench_state& state, typename protocol_handler< T >::value_type val )
+{
+        using handler = protocol_handler< T >;
+        std::vector< uint8_t > buffer;
+        buffer.reserve( handler::def::max_size );
+        handler::serialize_into( std::back_inserter( buffer ), val );
+        state.set_bytes_per_op( buffer.size() );
+        state.run( [&] {
+                buffer.clear();
+                handler::serialize_into( std::back_inserter( buffer ), val );
+                bench_do_not_optimize( buffer );
+        } );
+}
+
+template < typename T >
+void bench_extract( bench_state& state, typename protocol_handler< T >::value_type val )
+{
+        using handler = protocol_handler< T >;
+        auto msg      = handler::serialize( val );
+        state.set_bytes_per_op( msg.size() );
+        state.run( [&] {
+                auto res = handler::extract( msg );
+                bench_do_not_optimize( res );
+        } );
+}
+
+template < typename T >
+void bench_extract_many( bench_state& state, typename protocol_handler< T >::value_type val )
+{
+        using handler = protocol_handler< T >;
+        std::vector< typename handler::value_type > vals( 256, val );
+        std::vector< typename handler::value_type > res;
+        std::vector< uint8_t >                      buffer;
+        handler::serialize_many( vals, std::back_inserter( buffer ) );
+        res.reserve( vals.size() );
+        state.set_bytes_per_op( buffer.size() );
+        state.set_items_per_op( vals.size() );
+        state.run( [&] {
+                res.clear();
+                auto count = handler::extract_many( buffer, std::back_inserter( res ) );
+                bench_do_not_optimize( count );
+        } );
+}
+
+record_tuple::value_type make_record()
+{
+        std::array< uint16_t, 16 > samples{};
+        for ( std::size_t i = 0; i < samples.size(); i++ ) {
+                samples[i] = static_cast< uint16_t >( i * 1021 );
+        }
+        return record_tuple::make_val(
+            0xdeadbeef, 666, samples, -42, 3.14f, std::bitset< 12 >{ 0x5a5 } );
+}
+
+record_variant make_variant()
+{
+        return record_variant{
+            std::in_place_index< 4 >, std::tuple{ uint8_t{ 1 }, 2u, uint8_t{ 3 } } };
+}
+
+record_group::value_type make_command()
+{
+        return record_group::make_val< BC_MOVE >( -1, 1, 255, uint16_t{ 42 } );
+}
+
+record_group::value_type make_last_command()
+{
+        return record_group::make_val< BC_STREAM >(
+            42u, *protocol_sizeless_message< 32 >::make( std::array< uint8_t, 16 >{ 1, 2, 3 } ) );
+}
+
+// Consumes the arguments of commands, so that their decoding is not optimized out
+struct bench_cmd_sink
+{
+        template < auto ID, typename... Args >
+        void operator()( tag< ID >, const Args&... args )
+        {
+                ( bench_do_not_optimize( args ), ... );
+        }
+};
+
+// Passes command from the message to the handler, either through the dispatcher or by extracting
+// the variant of the group and visiting it
+template < bool Dispatch >
+void bench_command_handle( bench_state& state, record_group::value_type val )
+{
+        using handler    = protocol_handler< record_group >;
+        using dispatcher = protocol_dispatcher< record_group, bench_cmd_sink >;
+
+        auto           msg = handler::serialize( val );
+        bench_cmd_sink sink;
+        state.set_bytes_per_op( msg.size() );
+        state.run( [&] {
+                if constexpr ( Dispatch ) {
+                        bench_do_not_optimize( dispatcher::dispatch( msg, sink ) );
+                } else {
+                        handler::extract( msg ).match(
+                            [&]( const record_group::value_type& var ) {
+                                    apply_on_visit( sink, var );
+                            },
+                            [&]( const protocol_error_record& rec ) {
+                                    bench_do_not_optimize( rec );
+                            } );
+                }
+        } );
+}
+
+// Variant with N alternatives of same type, used to check that the cost of variant dispatch does
+// not depend on the index of the alternative
+template < typename T, typename Sequence >
+struct repeated_variant;
+
+template < typename T, std::size_t... Is >
+struct repeated_variant< T, std::index_sequence< Is... > >
+{
+        template < std::size_t >
+        using item_type = T;
+
+        using type = std::variant< item_type< Is >... >;
+};
+
+template < std::size_t N >
+using wide_variant = typename repeated_variant< uint32_t, std::make_index_sequence< N > >::type;
+
+// Reference def of variant, which finds the alternative by checking all of them one after another
+// until the index matches. This is how the variant def dispatched before it used the tables, it is
+// kept here so the benchmark shows the difference.
+template < typename Variant, protocol_endianess_enum Endianess >
+struct linear_variant_def;
+
+template < typename... Ds, protocol_endianess_enum Endianess >
+struct linear_variant_def< std::variant< Ds... >, Endianess >
+{
+        using def_type   = std::variant< Ds... >;
+        using table_def  = protocol_def< def_type, Endianess >;
+        using value_type = typename table_def::value_type;
+        using size_type  = typename table_def::size_type;
+        using id_type    = typename table_def::id_type;
+        using id_def     = typename table_def::id_def;
+
+        static constexpr std::size_t max_size = table_def::max_size;
+        static constexpr std::size_t id_size  = table_def::id_size;
+
+        static size_type
+        serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
+        {
+                id_def::serialize_at(
+                    buffer.template first< id_size >(), static_cast< id_type >( item.index() ) );
+
+                std::optional< size_type > opt_res;
+                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
+                        if ( i != item.index() ) {
+                                return false;
+                        }
+                        using sub_def =
+                            protocol_def< std::variant_alternative_t< i, def_type >, Endianess >;
+
+                        opt_res = bounded_constant< id_size > +
+                                  sub_def::serialize_at(
+                                      buffer.template subspan< id_size, sub_def::max_size >(),
+                                      std::get< i >( item ) );
+                        return true;
+                } );
+                return *opt_res;
+        }
+
+        static protocol_result< value_type >
+        deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
+        {
+                protocol_result< value_type > res{ 0, &UNDEFVAR_ERR };
+
+                auto [used, idres] = id_def::deserialize( buffer.template first< id_size >() );
+                if ( std::holds_alternative< const protocol_mark* >( idres ) ) {
+                        res.res = *std::get_if< const protocol_mark* >( &idres );
+                        return res;
+                }
+                id_type id        = std::get< 0 >( idres );
+                auto    item_view = buffer.template offset< id_size >();
+
+                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
+                        using sub_def =
+                            protocol_def< std::variant_alternative_t< i, def_type >, Endianess >;
+
+                        if ( id != i ) {
+                                return false;
+                        }
+                        auto opt_view =
+                            item_view.template opt_offset< typename sub_def::size_type >( 0 );
+                        if ( !opt_view ) {
+                                res.res = &SIZE_ERR;
+                                return true;
+                        }
+                        auto [sused, sres] = sub_def::deserialize( *opt_view );
+                        res.used           = used + sused;
+                        if ( std::holds_alternative< const protocol_mark* >( sres ) ) {
+                                res.res = *std::get_if< const protocol_mark* >( &sres );
+                        } else {
+                                res.res = value_type{
+                                    std::in_place_index< i >, *std::get_if< 0 >( &sres ) };
+                        }
+                        return true;
+                } );
+                return res;
+        }
+};
+
+template < std::size_t N >
+using table_variant_def = protocol_def< wide_variant< N >, PROTOCOL_BIG_ENDIAN >;
+
+template < std::size_t N >
+using linear_wide_variant_def = linear_variant_def< wide_variant< N >, PROTOCOL_BIG_ENDIAN >;
+
+template < template < std::size_t > typename Def, std::size_t N, std::size_t I >
+void bench_wide_variant_extract( bench_state& state )
+{
+        using def = Def< N >;
+
+        std::array< uint8_t, def::max_size > buffer{};
+        std::size_t                          used = *def::serialize_at(
+            buffer, wide_variant< N >{ std::in_place_index< I >, 0xcafe } );
+        auto bview = *bounded_view< const uint8_t*, typename def::size_type >::make(
+            view_n( buffer.data(), used ) );
+        state.set_bytes_per_op( used );
+        state.run( [&] {
+                bench_do_not_optimize( bview );
+                auto res = def::deserialize( bview );
+                bench_do_not_optimize( res );
+        } );
+}
+
+template < template < std::size_t > typename Def, std::size_t N, std::size_t I >
+void bench_wide_variant_serialize( bench_state& state )
+{
+        using def = Def< N >;
+
+        std::array< uint8_t, def::max_size > buffer{};
+        wide_variant< N >                    val{ std::in_place_index< I >, 0xcafe };
+        state.set_bytes_per_op( *def::serialize_at( buffer, val ) );
+        state.run( [&] {
+                bench_do_not_optimize( val );
+                auto used = def::serialize_at( buffer, val );
+                bench_do_not_optimize( used );
+                bench_do_not_optimize( buffer );
+        } );
+}
+
+// Registers extraction of the first and the last alternative, and serialization of the last one, of
+// variant with N alternatives. Each is measured with the table dispatch of the variant def and with
+// the linear reference.
+template < std::size_t N >
+void register_variant_dispatch()
+{
+        static constexpr std::size_t last   = N - 1;
+        const std::string            prefix = "protocol_variant_dispatch/" + std::to_string( N );
+
+        register_bench(
+            prefix + "/first/extract/linear",
+            &bench_wide_variant_extract< linear_wide_variant_def, N, 0 > );
+        register_bench(
+            prefix + "/first/extract/table",
+            &bench_wide_variant_extract< table_variant_def, N, 0 > );
+        register_bench(
+            prefix + "/last/extract/linear",
+            &bench_wide_variant_extract< linear_wide_variant_def, N, last > );
+        register_bench(
+            prefix + "/last/extract/table",
+            &bench_wide_variant_extract< table_variant_def, N, last > );
+        register_bench(
+            prefix + "/last/serialize/linear",
+            &bench_wide_variant_serialize< linear_wide_variant_def, N, last > );
+        register_bench(
+            prefix + "/last/serialize/table",
+            &bench_wide_variant_serialize< table_variant_def, N, last > );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "protocol_tuple/serialize", []( bench_state& state ) {
+                bench_serialize< record_tuple >( state, make_record() );
+        } );
+        register_bench( "protocol_tuple/serialize_into", []( bench_state& state ) {
+                bench_serialize_into< record_tuple >( state, make_record() );
+        } );
+        register_bench( "protocol_tuple/serialize_iterator", []( bench_state& state ) {
+                bench_serialize_iterator< record_tuple >( state, make_record() );
+        } );
+        register_bench( "protocol_tuple/extract", []( bench_state& state ) {
+                bench_extract< record_tuple >( state, make_record() );
+        } );
+        register_bench( "protocol_tuple/extract_many", []( bench_state& state ) {
+                bench_extract_many< record_tuple >( state, make_record() );
+        } );
+        register_bench( "protocol_variant/serialize", []( bench_state& state ) {
+                bench_serialize< record_variant >( state, make_variant() );
+        } );
+        register_bench( "protocol_variant/extract", []( bench_state& state ) {
+                bench_extract< record_variant >( state, make_variant() );
+        } );
+        register_bench( "protocol_command_group/serialize", []( bench_state& state ) {
+                bench_serialize< record_group >( state, make_command() );
+        } );
+        register_bench( "protocol_command_group/extract", []( bench_state& state ) {
+                bench_extract< record_group >( state, make_command() );
+        } );
+        register_bench( "protocol_command_group/extract_many", []( bench_state& state ) {
+                bench_extract_many< record_group >( state, make_command() );
+        } );
+        register_bench( "protocol_command_group/extract_last", []( bench_state& state ) {
+                bench_extract< record_group >( state, make_last_command() );
+        } );
+        register_bench( "protocol_command_group/extract_visit", []( bench_state& state ) {
+                bench_command_handle< false >( state, make_command() );
+        } );
+        register_bench( "protocol_command_group/dispatch", []( bench_state& state ) {
+                bench_command_handle< true >( state, make_command() );
+        } );
+        register_bench( "protocol_command_group/extract_visit_last", []( bench_state& state ) {
+                bench_command_handle< false >( state, make_last_command() );
+        } );
+        register_bench( "protocol_command_group/dispatch_last", []( bench_state& state ) {
+                bench_command_handle< true >( state, make_last_command() );
+        } );
+
+        register_variant_dispatch< 8 >();
+        register_variant_dispatch< 32 >();
+        register_variant_dispatch< 128 >();
+}
+
+}  // namespace
@@ -0,0 +1,333 @@
+#include "bench.h"
+#include "emlabcpp/protocol/concurrent_register_map.h"
+#include "emlabcpp/protocol/register_handler.h"
+#include "emlabcpp/protocol/register_image.h"
+#include "emlabcpp/protocol/register_map.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+// Map of N registers of 32 bit values, register `i` has key `i * Stride`, so stride 1 gives dense
+// keys and bigger strides give sparse keys
+template < std::size_t Stride, typename Sequence >
+struct bench_map_of;
+
+template < std::size_t Stride, std::size_t... Is >
+struct bench_map_of< Stride, std::index_sequence< Is... > >
+{
+        using type = protocol_register_map<
+            PROTOCOL_BIG_ENDIAN,
+            protocol_reg< static_cast< uint16_t >( Is * Stride ), uint32_t >... >;
+};
+
+template < std::size_t N, std::size_t Stride >
+using bench_map = typename bench_map_of< Stride, std::make_index_sequence< N > >::type;
+
+// Inserts value of the last register of the map, which is the worst case for linear search
+template < std::size_t N, std::size_t Stride >
+void bench_insert( bench_state& state )
+{
+        using map_type = bench_map< N, Stride >;
+        using handler  = protocol_register_handler< map_type >;
+
+        constexpr auto key = static_cast< uint16_t >( ( N - 1 ) * Stride );
+        map_type       m;
+        auto           msg = handler::template serialize< key >( 0xcafe );
+        state.set_bytes_per_op( msg.size() );
+        state.run( [&] {
+                auto res = handler::insert( m, key, msg );
+                bench_do_not_optimize( res );
+                bench_do_not_optimize( m );
+        } );
+}
+
+// Serializes value of the last register of the map
+template < std::size_t N, std::size_t Stride >
+void bench_select( bench_state& state )
+{
+        using map_type = bench_map< N, Stride >;
+        using handler  = protocol_register_handler< map_type >;
+
+        constexpr auto key = static_cast< uint16_t >( ( N - 1 ) * Stride );
+        map_type       m;
+        m.template set_val< key >( 0xcafe );
+        state.set_bytes_per_op( handler::select( m, key ).size() );
+        state.run( [&] {
+                auto msg = handler::select( m, key );
+                bench_do_not_optimize( msg );
+        } );
+}
+
+// One cycle of device synchronization in which four of the registers changed, either the whole map
+// is serialized register by register, or only the modified registers are serialized into delta
+template < std::size_t N, bool Delta >
+void bench_sync( bench_state& state )
+{
+        using map_type = protocol_tracked_register_map< bench_map< N, 1 > >;
+        using handler  = protocol_register_handler< map_type >;
+
+        map_type m;
+        uint32_t counter = 0;
+        auto     cycle   = [&] {
+                counter += 1;
+                m.template set_val< 3 >( counter );
+                m.template set_val< 42 >( counter );
+                m.template set_val< 100 >( counter );
+                m.template set_val< N - 1 >( counter );
+                std::size_t used = 0;
+                if constexpr ( Delta ) {
+                        auto msg = handler::serialize_delta( m );
+                        used     = msg.size();
+                        bench_do_not_optimize( msg );
+                } else {
+                        for ( std::size_t i = 0; i < N; i++ ) {
+                                auto index = *map_type::register_index::make( i );
+                                auto msg   = handler::select( m, map_type::register_key( index ) );
+                                used += msg.size();
+                                bench_do_not_optimize( msg );
+                        }
+                }
+                return used;
+        };
+        state.set_bytes_per_op( cycle() );
+        state.run( [&] {
+                bench_do_not_optimize( cycle() );
+        } );
+}
+
+// Transfer of burst of 32 consecutive registers into transmit buffer, either as one block or
+// register by register
+template < std::size_t N, bool Range >
+void bench_burst_select( bench_state& state )
+{
+        using map_type = bench_map< N, 1 >;
+        using handler  = protocol_register_handler< map_type >;
+
+        constexpr uint16_t                             first = 64;
+        constexpr uint16_t                             last  = first + 31;
+        map_type                                       m;
+        std::array< uint8_t, handler::range_max_size > buffer;
+        auto                                           burst = [&] {
+                std::size_t used = 0;
+                if constexpr ( Range ) {
+                        used = *handler::select_range_into( m, first, last, buffer );
+                } else {
+                        for ( uint16_t key = first; key <= last; key++ ) {
+                                used += *handler::select_into(
+                                    m, key, std::span{ buffer }.subspan( used ) );
+                        }
+                }
+                bench_do_not_optimize( buffer );
+                return used;
+        };
+        state.set_bytes_per_op( burst() );
+        state.run( [&] {
+                bench_do_not_optimize( burst() );
+        } );
+}
+
+template < std::size_t N, bool Range >
+void bench_burst_insert( bench_state& state )
+{
+        using map_type = bench_map< N, 1 >;
+        using handler  = protocol_register_handler< map_type >;
+
+        constexpr uint16_t first = 64;
+        constexpr uint16_t last  = first + 31;
+        map_type           m;
+        auto               block = *handler::select_range( m, first, last );
+
+        std::vector< typename handler::message_type > msgs;
+        for ( uint16_t key = first; key <= last; key++ ) {
+                msgs.push_back( handler::select( m, key ) );
+        }
+        state.set_bytes_per_op( block.size() );
+        state.run( [&] {
+                if constexpr ( Range ) {
+                        bench_do_not_optimize( handler::insert_range( m, first, block ) );
+                } else {
+                        uint16_t key = first;
+                        for ( const auto& msg : msgs ) {
+                                bench_do_not_optimize( handler::insert( m, key, msg ) );
+                                key++;
+                        }
+                }
+                bench_do_not_optimize( m );
+        } );
+}
+
+// Register map shared by one writer and readers, guarded by mutex
+template < typename Map >
+class bench_locked_map
+{
+public:
+        template < typename Map::key_type Key >
+        void set_val( typename Map::template reg_value_type< Key > val )
+        {
+                std::lock_guard lock{ mutex_ };
+                map_.template set_val< Key >( val );
+        }
+
+        template < typename Map::key_type Key >
+        typename Map::template reg_value_type< Key > get_val() const
+        {
+                std::lock_guard lock{ mutex_ };
+                return map_.template get_val< Key >();
+        }
+
+        Map snapshot() const
+        {
+                std::lock_guard lock{ mutex_ };
+                return map_;
+        }
+
+private:
+        mutable std::mutex mutex_;
+        Map                map_;
+};
+
+// Measured reader reads register 3 or the whole map of 32 registers, while writer thread keeps
+// updating register 3 and `Readers - 1` other threads keep reading it
+template < typename Shared, std::size_t Readers, bool Snapshot >
+void bench_shared_read( bench_state& state )
+{
+        Shared              m;
+        std::atomic< bool > done{ false };
+
+        std::vector< std::thread > threads;
+        threads.emplace_back( [&] {
+                uint32_t counter = 0;
+                while ( !done.load( std::memory_order_relaxed ) ) {
+                        m.template set_val< 3 >( ++counter );
+                        std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+                }
+        } );
+        for ( std::size_t i = 1; i < Readers; i++ ) {
+                threads.emplace_back( [&] {
+                        while ( !done.load( std::memory_order_relaxed ) ) {
+                                bench_do_not_optimize( m.template get_val< 3 >() );
+                        }
+                } );
+        }
+
+        state.run( [&] {
+                if constexpr ( Snapshot ) {
+                        bench_do_not_optimize( m.snapshot() );
+                } else {
+                        bench_do_not_optimize( m.template get_val< 3 >() );
+                }
+        } );
+
+        done = true;
+        for ( std::thread& t : threads ) {
+                t.join();
+        }
+}
+
+using bench_shared_base = bench_map< 32, 1 >;
+using bench_seqlock_map = protocol_concurrent_register_map< bench_shared_base >;
+using bench_mutex_map   = bench_locked_map< bench_shared_base >;
+
+// Loads 1000 stored configurations of map with N registers, stored either as images or as
+// records of key and value for each register, as is done by insert_delta
+template < std::size_t N, bool Image >
+void bench_load_configs( bench_state& state )
+{
+        using map_type = bench_map< N, 1 >;
+        using tracked  = protocol_tracked_register_map< map_type >;
+        using handler  = protocol_register_handler< tracked >;
+        using image    = protocol_register_image< tracked >;
+
+        static constexpr std::size_t configs = 1000;
+
+        std::vector< uint8_t >     storage;
+        std::vector< std::size_t > sizes;
+        for ( std::size_t i = 0; i < configs; i++ ) {
+                tracked m;
+                m.template set_val< 0 >( static_cast< uint32_t >( i ) );
+                if constexpr ( Image ) {
+                        auto msg = image::serialize( m );
+                        storage.insert( storage.end(), msg.begin(), msg.end() );
+                        sizes.push_back( msg.size() );
+                } else {
+                        m.mark_all_dirty();
+                        auto msg = handler::serialize_delta( m );
+                        storage.insert( storage.end(), msg.begin(), msg.end() );
+                        sizes.push_back( msg.size() );
+                }
+        }
+
+        std::vector< tracked > maps( configs );
+        state.set_items_per_op( configs );
+        state.set_bytes_per_op( storage.size() );
+        state.run( [&] {
+                const uint8_t* iter = storage.data();
+                for ( std::size_t i = 0; i < configs; i++ ) {
+                        auto data = view_n( iter, sizes[i] );
+                        if constexpr ( Image ) {
+                                bench_do_not_optimize( image::insert( maps[i], data ) );
+                        } else {
+                                bench_do_not_optimize( handler::insert_delta( maps[i], data ) );
+                        }
+                        iter += sizes[i];
+                }
+                bench_clobber_memory();
+        } );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "protocol_register_map/8/dense/insert", &bench_insert< 8, 1 > );
+        register_bench( "protocol_register_map/160/dense/insert", &bench_insert< 160, 1 > );
+        register_bench( "protocol_register_map/160/sparse/insert", &bench_insert< 160, 97 > );
+        register_bench( "protocol_register_map/8/dense/select", &bench_select< 8, 1 > );
+        register_bench( "protocol_register_map/160/dense/select", &bench_select< 160, 1 > );
+        register_bench( "protocol_register_map/160/sparse/select", &bench_select< 160, 97 > );
+        register_bench( "protocol_register_map/160/sync/select_all", &bench_sync< 160, false > );
+        register_bench( "protocol_register_map/160/sync/delta", &bench_sync< 160, true > );
+        register_bench(
+            "protocol_register_map/160/burst/select", &bench_burst_select< 160, false > );
+        register_bench(
+            "protocol_register_map/160/burst/select_range", &bench_burst_select< 160, true > );
+        register_bench(
+            "protocol_register_map/160/burst/insert", &bench_burst_insert< 160, false > );
+        register_bench(
+            "protocol_register_map/160/burst/insert_range", &bench_burst_insert< 160, true > );
+        register_bench(
+            "protocol_register_map/32/shared/1_reader/mutex/get_val",
+            &bench_shared_read< bench_mutex_map, 1, false > );
+        register_bench(
+            "protocol_register_map/32/shared/1_reader/seqlock/get_val",
+            &bench_shared_read< bench_seqlock_map, 1, false > );
+        register_bench(
+            "protocol_register_map/32/shared/4_readers/mutex/get_val",
+            &bench_shared_read< bench_mutex_map, 4, false > );
+        register_bench(
+            "protocol_register_map/32/shared/4_readers/seqlock/get_val",
+            &bench_shared_read< bench_seqlock_map, 4, false > );
+        register_bench(
+            "protocol_register_map/32/shared/1_reader/mutex/snapshot",
+            &bench_shared_read< bench_mutex_map, 1, true > );
+        register_bench(
+            "protocol_register_map/32/shared/1_reader/seqlock/snapshot",
+            &bench_shared_read< bench_seqlock_map, 1, true > );
+        register_bench(
+            "protocol_register_map/32/shared/4_readers/mutex/snapshot",
+            &bench_shared_read< bench_mutex_map, 4, true > );
+        register_bench(
+            "protocol_register_map/32/shared/4_readers/seqlock/snapshot",
+            &bench_shared_read< bench_seqlock_map, 4, true > );
+        register_bench(
+            "protocol_register_map/160/load_1000/records", &bench_load_configs< 160, false > );
+        register_bench(
+            "protocol_register_map/160/load_1000/image", &bench_load_configs< 160, true > );
+}
+
+}  // namespace
@@ -0,0 +1,326 @@
+#include "bench.h"
+#include "emlabcpp/experimental/capture.h"
+#include "emlabcpp/protocol/packet.h"
+#include "emlabcpp/protocol/packet_handler.h"
+
+#include <filesystem>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+struct bench_packet_def
+{
+        static constexpr protocol_endianess_enum  endianess = PROTOCOL_BIG_ENDIAN;
+        static constexpr std::array< uint8_t, 4 > prefix    = { 0x91, 0x19, 0x91, 0x19 };
+        using size_type                                     = uint16_t;
+        using checksum_type                                 = uint16_t;
+
+        static constexpr checksum_type get_checksum( const view< const uint8_t* > )
+        {
+                return 0x00;
+        }
+};
+
+// Same checksum, once computed after the message is sequenced and once incrementally during
+struct bench_crc_def
+{
+        static constexpr protocol_endianess_enum  endianess = PROTOCOL_BIG_ENDIAN;
+        static constexpr std::array< uint8_t, 4 > prefix    = { 0x91, 0x19, 0x91, 0x19 };
+        using size_type                                     = uint16_t;
+        using checksum_type                                 = uint32_t;
+
+        static constexpr checksum_type get_checksum( const view< const uint8_t* > mview )
+        {
+                return crc32c::compute( mview );
+        }
+};
+
+struct bench_incremental_crc_def : protocol_packet_crc< crc32c >
+{
+        static constexpr protocol_endianess_enum  endianess = PROTOCOL_BIG_ENDIAN;
+        static constexpr std::array< uint8_t, 4 > prefix    = { 0x91, 0x19, 0x91, 0x19 };
+        using size_type                                     = uint16_t;
+};
+
+using bench_payload =
+    protocol_tuple< PROTOCOL_BIG_ENDIAN, uint32_t, uint16_t, std::array< uint8_t, 48 > >;
+using bench_packet = protocol_packet< bench_packet_def, bench_payload >;
+using bench_seq      = typename bench_packet::sequencer;
+using bench_view_seq = typename bench_packet::view_sequencer;
+
+using bench_crc_packet = protocol_packet< bench_crc_def, bench_payload >;
+using bench_incremental_crc_packet =
+    protocol_packet< bench_incremental_crc_def, bench_payload >;
+
+constexpr std::size_t stream_messages = 256;
+
+// Stream of back to back packets, optionally with `noise` bytes of garbage between them
+std::vector< uint8_t > make_stream( std::size_t noise )
+{
+        std::vector< uint8_t > res;
+        for ( std::size_t i = 0; i < stream_messages; i++ ) {
+                auto msg = protocol_packet_handler< bench_packet >::serialize(
+                    { static_cast< uint32_t >( i ), uint16_t{ 42 }, {} } );
+                for ( std::size_t j = 0; j < noise; j++ ) {
+                        res.push_back( static_cast< uint8_t >( ( i + j ) * 7 ) );
+                }
+                res.insert( res.end(), msg.begin(), msg.end() );
+        }
+        return res;
+}
+
+// Feeds the stream to sequencer in chunks of size requested by the sequencer, in the same way as
+// protocol_simple_load does.
+std::size_t load_stream( const std::vector< uint8_t >& stream )
+{
+        bench_seq   seq;
+        std::size_t count   = 0;
+        std::size_t to_read = bench_seq::fixed_size;
+        auto        iter    = stream.begin();
+        while ( iter != stream.end() ) {
+                std::size_t n = std::min(
+                    to_read, static_cast< std::size_t >( std::distance( iter, stream.end() ) ) );
+                seq.load_data( view_n( iter, n ) )
+                    .match(
+                        [&]( std::size_t next_read ) {
+                                to_read = next_read;
+                        },
+                        [&]( const auto& msg ) {
+                                bench_do_not_optimize( msg );
+                                to_read = bench_seq::fixed_size;
+                                count += 1;
+                        } );
+                std::advance( iter, n );
+        }
+        return count;
+}
+
+// Feeds the stream in fixed chunks and drains every complete message from each chunk, as when the
+// transport delivers bursts of data.
+std::size_t drain_stream( const std::vector< uint8_t >& stream, std::size_t chunk )
+{
+        bench_seq   seq;
+        std::size_t count = 0;
+        for ( std::size_t offset = 0; offset < stream.size(); offset += chunk ) {
+                std::size_t n = std::min( chunk, stream.size() - offset );
+                seq.load_data( view_n( stream.data() + offset, n ), [&]( const auto& msg ) {
+                        bench_do_not_optimize( msg );
+                        count += 1;
+                } );
+        }
+        return count;
+}
+
+// Same as drain_stream, but messages are passed out as views into the sequencer buffer and
+// are not copied out of it
+template < typename Sequencer = bench_view_seq >
+std::size_t drain_view_stream( const std::vector< uint8_t >& stream, std::size_t chunk )
+{
+        Sequencer   seq;
+        std::size_t count = 0;
+        for ( std::size_t offset = 0; offset < stream.size(); offset += chunk ) {
+                std::size_t n = std::min( chunk, stream.size() - offset );
+                seq.load_view( view_n( stream.data() + offset, n ), [&]( const auto& msg ) {
+                        bench_do_not_optimize( msg );
+                        count += 1;
+                } );
+        }
+        return count;
+}
+
+// Sequences and decodes the stream of packets with checksum. For packets with incremental checksum
+// the sequencer checks the checksum, with `Sequenced` extract_sequenced is used and the checksum is
+// not computed again by extract.
+template < typename Packet, bool Sequenced >
+std::size_t decode_stream( const std::vector< uint8_t >& stream, std::size_t chunk )
+{
+        using handler = protocol_packet_handler< Packet >;
+
+        typename Packet::view_sequencer seq;
+        std::size_t                     count = 0;
+        for ( std::size_t offset = 0; offset < stream.size(); offset += chunk ) {
+                std::size_t n = std::min( chunk, stream.size() - offset );
+                seq.load_view( view_n( stream.data() + offset, n ), [&]( const auto& msg ) {
+                        if constexpr ( Sequenced ) {
+                                auto res = handler::extract_sequenced( msg );
+                                count += res.is_left() ? 1 : 0;
+                        } else {
+                                auto res = handler::extract( msg );
+                                count += res.is_left() ? 1 : 0;
+                        }
+                } );
+        }
+        return count;
+}
+
+template < typename Packet >
+std::vector< uint8_t > make_packet_stream()
+{
+        std::vector< uint8_t > res;
+        for ( std::size_t i = 0; i < stream_messages; i++ ) {
+                auto msg = protocol_packet_handler< Packet >::serialize(
+                    { static_cast< uint32_t >( i ), uint16_t{ 42 }, {} } );
+                res.insert( res.end(), msg.begin(), msg.end() );
+        }
+        return res;
+}
+
+template < typename Packet, bool Sequenced >
+void bench_decode( bench_state& state )
+{
+        std::vector< uint8_t > stream = make_packet_stream< Packet >();
+        state.set_bytes_per_op( stream.size() );
+        state.set_items_per_op( stream_messages );
+        state.run( [&] {
+                std::size_t count = decode_stream< Packet, Sequenced >( stream, 512 );
+                bench_do_not_optimize( count );
+        } );
+}
+
+template < typename Packet >
+void bench_packet_serialize( bench_state& state )
+{
+        using handler = protocol_packet_handler< Packet >;
+        typename Packet::value_type val{ 42u, uint16_t{ 666 }, {} };
+        state.set_bytes_per_op( handler::serialize( val ).size() );
+        state.run( [&] {
+                auto msg = handler::serialize( val );
+                bench_do_not_optimize( msg );
+        } );
+}
+
+template < typename Packet >
+void bench_packet_serialize_into( bench_state& state )
+{
+        using handler = protocol_packet_handler< Packet >;
+        typename Packet::value_type              val{ 42u, uint16_t{ 666 }, {} };
+        std::array< uint8_t, handler::max_size > buffer;
+        state.set_bytes_per_op( *handler::serialize_into( buffer, val ) );
+        state.run( [&] {
+                auto used = handler::serialize_into( buffer, val );
+                bench_do_not_optimize( used );
+                bench_do_not_optimize( buffer );
+        } );
+}
+
+// Replays capture of noisy stream recorded in 512 byte chunks, from file mapped into memory
+void bench_replay( bench_state& state )
+{
+        std::vector< uint8_t > stream = make_stream( 64 );
+        std::filesystem::path  path =
+            std::filesystem::temp_directory_path() / "emlabcpp_bench_capture.bin";
+        {
+                protocol_capture_writer writer{ path.c_str() };
+                for ( std::size_t offset = 0; offset < stream.size(); offset += 512 ) {
+                        std::size_t n = std::min< std::size_t >( 512, stream.size() - offset );
+                        writer.record( view_n( stream.data() + offset, n ) );
+                }
+        }
+        protocol_capture_file file{ path.c_str() };
+
+        state.set_bytes_per_op( stream.size() );
+        state.set_items_per_op( stream_messages );
+        state.run( [&] {
+                auto rep = protocol_capture_replay< bench_packet >(
+                    *file.reader(), PROTOCOL_REPLAY_MAX_THROUGHPUT, []( const auto& val ) {
+                            bench_do_not_optimize( val );
+                    } );
+                bench_do_not_optimize( rep );
+        } );
+        std::filesystem::remove( path );
+}
+
+template < auto Drain >
+void bench_drain( bench_state& state, std::size_t noise )
+{
+        std::vector< uint8_t > stream = make_stream( noise );
+        state.set_bytes_per_op( stream.size() );
+        state.set_items_per_op( stream_messages );
+        state.run( [&] {
+                std::size_t count = Drain( stream, 512 );
+                bench_do_not_optimize( count );
+        } );
+}
+
+void bench_load( bench_state& state, std::size_t noise )
+{
+        std::vector< uint8_t > stream = make_stream( noise );
+        state.set_bytes_per_op( stream.size() );
+        state.set_items_per_op( stream_messages );
+        state.run( [&] {
+                std::size_t count = load_stream( stream );
+                bench_do_not_optimize( count );
+        } );
+}
+
+EMLABCPP_REGISTER_BENCHMARKS()
+{
+        register_bench( "protocol_sequencer/load_data/clean", []( bench_state& state ) {
+                bench_load( state, 0 );
+        } );
+        register_bench( "protocol_sequencer/load_data/noisy", []( bench_state& state ) {
+                bench_load( state, 64 );
+        } );
+        register_bench( "protocol_sequencer/load_data/garbage", []( bench_state& state ) {
+                bench_load( state, 1024 );
+        } );
+        register_bench( "protocol_sequencer/load_data_drain/clean", []( bench_state& state ) {
+                bench_drain< drain_stream >( state, 0 );
+        } );
+        register_bench( "protocol_sequencer/load_data_drain/garbage", []( bench_state& state ) {
+                bench_drain< drain_stream >( state, 1024 );
+        } );
+        register_bench( "protocol_sequencer/load_view_drain/clean", []( bench_state& state ) {
+                bench_drain< drain_view_stream<> >( state, 0 );
+        } );
+        register_bench( "protocol_sequencer/load_view_drain/garbage", []( bench_state& state ) {
+                bench_drain< drain_view_stream<> >( state, 1024 );
+        } );
+        register_bench(
+            "protocol_sequencer/load_view_drain_stats/garbage", []( bench_state& state ) {
+                    using seq = typename bench_packet::stats_view_sequencer< protocol_stats<> >;
+                    bench_drain< drain_view_stream< seq > >( state, 1024 );
+            } );
+        register_bench( "protocol_capture/replay", bench_replay );
+        register_bench( "protocol_packet/crc32c/extract", []( bench_state& state ) {
+                bench_decode< bench_crc_packet, false >( state );
+        } );
+        register_bench( "protocol_packet/crc32c/extract_incremental", []( bench_state& state ) {
+                bench_decode< bench_incremental_crc_packet, false >( state );
+        } );
+        register_bench( "protocol_packet/crc32c/extract_sequenced", []( bench_state& state ) {
+                bench_decode< bench_incremental_crc_packet, true >( state );
+        } );
+        register_bench( "protocol_packet_handler/serialize", []( bench_state& state ) {
+                bench_packet_serialize< bench_packet >( state );
+        } );
+        register_bench( "protocol_packet_handler/serialize_into", []( bench_state& state ) {
+                bench_packet_serialize_into< bench_packet >( state );
+        } );
+        register_bench( "protocol_packet/crc32c/serialize", []( bench_state& state ) {
+                bench_packet_serialize< bench_crc_packet >( state );
+        } );
+        register_bench( "protocol_packet/crc32c/serialize_into", []( bench_state& state ) {
+                bench_packet_serialize_into< bench_crc_packet >( state );
+        } );
+        register_bench( "protocol_packet/crc32c/serialize_incremental", []( bench_state& state ) {
+                bench_packet_serialize< bench_incremental_crc_packet >( state );
+        } );
+        register_bench(
+            "protocol_packet/crc32c/serialize_into_incremental", []( bench_state& state ) {
+                    bench_packet_serialize_into< bench_incremental_crc_packet >( state );
+            } );
+        register_bench( "protocol_packet_handler/extract", []( bench_state& state ) {
+                using handler = protocol_packet_handler< bench_packet >;
+                auto msg      = handler::serialize( { 42u, uint16_t{ 666 }, {} } );
+                state.set_bytes_per_op( msg.size() );
+                state.run( [&] {
+                        auto res = handler::extract( msg );
+                        bench_do_not_optimize( res );
+                } );
+        } );
+}
+
+}  // namespace
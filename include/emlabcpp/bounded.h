@@ -58,7 +58,7 @@ public:
         // Static method optinally returns bounded value, only in case the input value is withing
         // allowed range.
         template < typename U >
-        static std::optional< bounded< T, min_val, max_val > > make( U val )
+        static constexpr std::optional< bounded< T, min_val, max_val > > make( U val )
         {
                 if ( static_cast< T >( val ) < min_val ) {
                         return {};
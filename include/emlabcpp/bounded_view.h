@@ -16,7 +16,7 @@ public:
         static constexpr std::size_t max = size_type::max_val;
 
 private:
-        bounded_view( iterator beg, iterator end )
+        constexpr bounded_view( iterator beg, iterator end )
           : view< Iterator >( beg, end )
         {
         }
@@ -27,7 +27,7 @@ public:
 
         template < bounded_derived OtherSize >
         requires( OtherSize::min_val >= min && OtherSize::max_val <= max )
-            bounded_view( const bounded_view< Iterator, OtherSize >& other )
+            constexpr bounded_view( const bounded_view< Iterator, OtherSize >& other )
           : bounded_view( other.begin(), other.end() )
         {
         }
@@ -36,12 +36,12 @@ public:
         requires(
             range_container< Container >&& static_sized< Container >&&
                                            std::tuple_size_v< Container > <= max &&
-            std::tuple_size_v< Container > >= min ) bounded_view( Container& cont )
+            std::tuple_size_v< Container > >= min ) constexpr bounded_view( Container& cont )
           : bounded_view( cont.begin(), cont.end() )
         {
         }
 
-        static std::optional< bounded_view > make( view< Iterator > v )
+        static constexpr std::optional< bounded_view > make( view< Iterator > v )
         {
                 if ( v.size() < min ) {
                         return {};
@@ -52,15 +52,24 @@ public:
                 return { bounded_view( v.begin(), v.end() ) };
         }
 
+        // Creates view of `n` items starting at `beg`, the size is checked at compile time and the
+        // caller guarantees that the items exist.
+        template < std::size_t n >
+        requires( n >= min && n <= max ) static constexpr bounded_view make_n( iterator beg )
+        {
+                return { beg, beg + n };
+        }
+
         template < std::size_t n >
         requires( n <= min )
-            [[nodiscard]] bounded_view< iterator, bounded< std::size_t, n, n > > first() const
+            [[nodiscard]] constexpr bounded_view< iterator, bounded< std::size_t, n, n > >
+            first() const
         {
                 return { this->begin(), this->begin() + n };
         }
 
         template < std::size_t n >
-        requires( n <= min ) [[nodiscard]] bounded_view<
+        requires( n <= min ) [[nodiscard]] constexpr bounded_view<
             iterator,
             bounded< std::size_t, min - n, max - n > > offset() const
         {
@@ -68,7 +77,8 @@ public:
         }
 
         template < typename OffsetSizeType >
-        std::optional< bounded_view< iterator, OffsetSizeType > > opt_offset( std::size_t offset )
+        constexpr std::optional< bounded_view< iterator, OffsetSizeType > >
+        opt_offset( std::size_t offset )
         {
                 auto new_beg = this->begin() + offset;
                 if ( new_beg + OffsetSizeType::min_val > this->end() ) {
@@ -0,0 +1,203 @@
+#include "emlabcpp/view.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if defined( __SSE4_2__ ) && defined( __x86_64__ )
+#include <nmmintrin.h>
+#endif
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// CRC with register of type `T`, generator polynomial `Poly` (normal form), initial value `Init`
+// and final xor `XorOut`. In case `Reflected` is true, bits of each byte are processed from the
+// least significant one and the checksum is reflected. Parameters are the same as in the usual
+// catalogues of CRC algorithms.
+//
+// Data are processed eight bytes at a time with slicing-by-8 tables, which are generated at compile
+// time. The checksum can be computed at once with `compute`, or incrementally by passing the
+// register from `init` through calls of `update` to `finalize`.
+template < typename T, T Poly, T Init, T XorOut, bool Reflected >
+class crc
+{
+public:
+        using value_type = T;
+
+        static constexpr std::size_t width     = sizeof( T ) * 8;
+        static constexpr value_type  poly      = Poly;
+        static constexpr bool        reflected = Reflected;
+
+        using table_type = std::array< std::array< value_type, 256 >, 8 >;
+
+        static constexpr value_type init()
+        {
+                if constexpr ( Reflected ) {
+                        return reflect( Init );
+                } else {
+                        return Init;
+                }
+        }
+
+        static constexpr value_type update( value_type reg, view< const uint8_t* > data )
+        {
+#if defined( __SSE4_2__ ) && defined( __x86_64__ )
+                if constexpr ( is_crc32c ) {
+                        if ( !std::is_constant_evaluated() ) {
+                                return hw_update( reg, data );
+                        }
+                }
+#endif
+                const uint8_t* iter = data.begin();
+                std::size_t    n    = data.size();
+                for ( ; n >= 8; n -= 8, iter += 8 ) {
+                        reg = slice8( reg, iter, std::make_index_sequence< 8 >{} );
+                }
+                for ( ; n > 0; n--, iter++ ) {
+                        uint8_t x = static_cast< uint8_t >( *iter ^ top_byte( reg ) );
+                        reg       = static_cast< value_type >( shift( reg ) ^ tables[0][x] );
+                }
+                return reg;
+        }
+
+        static constexpr value_type finalize( value_type reg )
+        {
+                return static_cast< value_type >( reg ^ XorOut );
+        }
+
+        static constexpr value_type compute( view< const uint8_t* > data )
+        {
+                return finalize( update( init(), data ) );
+        }
+
+private:
+        static constexpr bool is_crc32c = std::is_same_v< value_type, uint32_t > && Reflected &&
+                                          Poly == 0x1EDC6F41;
+
+        static constexpr value_type reflect( value_type val )
+        {
+                value_type res = 0;
+                for ( std::size_t i = 0; i < width; i++ ) {
+                        if ( val & ( value_type{ 1 } << i ) ) {
+                                res = static_cast< value_type >(
+                                    res | ( value_type{ 1 } << ( width - 1 - i ) ) );
+                        }
+                }
+                return res;
+        }
+
+        // Register after processing byte `v` with register cleared
+        static constexpr value_type byte_step( value_type v )
+        {
+                if constexpr ( Reflected ) {
+                        constexpr value_type rpoly = reflect( Poly );
+                        for ( std::size_t i = 0; i < 8; i++ ) {
+                                v = static_cast< value_type >(
+                                    ( v & 1 ) ? ( v >> 1 ) ^ rpoly : ( v >> 1 ) );
+                        }
+                } else {
+                        constexpr value_type top = value_type{ 1 } << ( width - 1 );
+                        v = static_cast< value_type >( v << ( width - 8 ) );
+                        for ( std::size_t i = 0; i < 8; i++ ) {
+                                v = static_cast< value_type >(
+                                    ( v & top ) ? ( v << 1 ) ^ Poly : ( v << 1 ) );
+                        }
+                }
+                return v;
+        }
+
+        // Byte of the register that is combined with the next data byte
+        static constexpr uint8_t top_byte( value_type reg )
+        {
+                return register_byte( reg, 0 );
+        }
+
+        // Byte of the register that is combined with the `i`-th next data byte
+        static constexpr uint8_t register_byte( value_type reg, std::size_t i )
+        {
+                if constexpr ( Reflected ) {
+                        return static_cast< uint8_t >( reg >> ( 8 * i ) );
+                } else {
+                        return static_cast< uint8_t >( reg >> ( width - 8 - 8 * i ) );
+                }
+        }
+
+        // Processes eight bytes at once, each byte is looked up in its own table. Bytes of the
+        // register are combined with the first bytes of the data.
+        template < std::size_t... Is >
+        static constexpr value_type
+        slice8( value_type reg, const uint8_t* iter, std::index_sequence< Is... > )
+        {
+                auto x = [&]( std::size_t i ) -> uint8_t {
+                        if ( i < sizeof( value_type ) ) {
+                                return static_cast< uint8_t >( iter[i] ^ register_byte( reg, i ) );
+                        }
+                        return iter[i];
+                };
+                return static_cast< value_type >( ( tables[7 - Is][x( Is )] ^ ... ) );
+        }
+
+        // Register with the top byte shifted out
+        static constexpr value_type shift( value_type reg )
+        {
+                if constexpr ( width == 8 ) {
+                        return 0;
+                } else if constexpr ( Reflected ) {
+                        return static_cast< value_type >( reg >> 8 );
+                } else {
+                        return static_cast< value_type >( reg << 8 );
+                }
+        }
+
+#if defined( __SSE4_2__ ) && defined( __x86_64__ )
+        static value_type hw_update( value_type reg, view< const uint8_t* > data )
+        {
+                const uint8_t* iter = data.begin();
+                std::size_t    n    = data.size();
+                uint64_t       reg64 = reg;
+                for ( ; n >= 8; n -= 8, iter += 8 ) {
+                        uint64_t word;
+                        std::memcpy( &word, iter, sizeof( word ) );
+                        reg64 = _mm_crc32_u64( reg64, word );
+                }
+                auto res = static_cast< uint32_t >( reg64 );
+                for ( ; n > 0; n--, iter++ ) {
+                        res = _mm_crc32_u8( res, *iter );
+                }
+                return res;
+        }
+#endif
+
+public:
+        // tables[k][v] is the register after processing byte `v` followed by `k` zero bytes
+        static constexpr table_type tables = [] {
+                table_type res{};
+                for ( std::size_t v = 0; v < 256; v++ ) {
+                        res[0][v] = byte_step( static_cast< value_type >( v ) );
+                }
+                for ( std::size_t k = 1; k < 8; k++ ) {
+                        for ( std::size_t v = 0; v < 256; v++ ) {
+                                value_type prev = res[k - 1][v];
+                                res[k][v]       = static_cast< value_type >(
+                                    shift( prev ) ^ res[0][top_byte( prev )] );
+                        }
+                }
+                return res;
+        }();
+};
+
+// CRC-8/SMBUS
+using crc8 = crc< uint8_t, 0x07, 0x00, 0x00, false >;
+// CRC-16/CCITT-FALSE, also known as CRC-16/IBM-3740
+using crc16_ccitt = crc< uint16_t, 0x1021, 0xFFFF, 0x0000, false >;
+// CRC-32/ISO-HDLC, used by ethernet, zlib and others
+using crc32 = crc< uint32_t, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true >;
+// CRC-32C (Castagnoli), calculated with SSE4.2 instructions when those are enabled
+using crc32c = crc< uint32_t, 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF, true >;
+
+}  // namespace emlabcpp
@@ -0,0 +1,340 @@
+#include "emlabcpp/experimental/mapped_file.h"
+#include "emlabcpp/protocol/packet_handler.h"
+#include "emlabcpp/protocol/serializer.h"
+#include "emlabcpp/protocol/stats.h"
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <thread>
+
+#ifdef EMLABCPP_USE_STREAMS
+#include "emlabcpp/protocol/streams.h"
+#endif
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Capture file stores the stream of bytes received by transport as timestamped chunks. The file
+// starts with `protocol_capture_magic` and the chunks follow, each made of:
+//  - timestamp in nanoseconds since start of the capture, 64 bit little endian
+//  - size of the data, 32 bit little endian
+//  - the data
+// Nothing is aligned, so the file can be read directly from memory it is mapped to.
+static constexpr std::array< uint8_t, 8 > protocol_capture_magic = {
+    'E', 'M', 'L', 'B', 'C', 'A', 'P', '1' };
+
+struct protocol_capture_chunk
+{
+        std::chrono::nanoseconds timestamp;
+        view< const uint8_t* >   data;
+};
+
+namespace detail
+{
+        using capture_time_serializer = protocol_serializer< uint64_t, PROTOCOL_LITTLE_ENDIAN >;
+        using capture_size_serializer = protocol_serializer< uint32_t, PROTOCOL_LITTLE_ENDIAN >;
+
+        static constexpr std::size_t capture_chunk_header_size =
+            capture_time_serializer::max_size + capture_size_serializer::max_size;
+}  // namespace detail
+
+// Writes the capture file. Transport calls `record` with each chunk of received bytes, the
+// timestamp is taken from steady clock relative to the creation of the writer. Once any write
+// fails, `good()` is false and nothing more is written. Writes are buffered, so the failure might be
+// detected only by `flush()`.
+class protocol_capture_writer
+{
+public:
+        using clock = std::chrono::steady_clock;
+
+        // data bigger than this are recorded as multiple chunks with the same timestamp
+        static constexpr std::size_t max_chunk_size = std::numeric_limits< uint32_t >::max();
+
+        explicit protocol_capture_writer( const char* path )
+          : file_( std::fopen( path, "wb" ) )
+          , start_( clock::now() )
+          , good_( file_ != nullptr )
+        {
+                write( protocol_capture_magic.data(), protocol_capture_magic.size() );
+        }
+
+        protocol_capture_writer( const protocol_capture_writer& )            = delete;
+        protocol_capture_writer& operator=( const protocol_capture_writer& ) = delete;
+
+        [[nodiscard]] bool is_open() const
+        {
+                return file_ != nullptr;
+        }
+
+        // False in case the file could not be opened or any write to it failed
+        [[nodiscard]] bool good() const
+        {
+                return good_;
+        }
+
+        void record( view< const uint8_t* > data )
+        {
+                record(
+                    std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - start_ ),
+                    data );
+        }
+
+        void record( std::chrono::nanoseconds timestamp, view< const uint8_t* > data )
+        {
+                const uint8_t* iter = data.begin();
+                std::size_t    left = data.size();
+                do {
+                        std::size_t n = std::min( left, max_chunk_size );
+                        record_chunk( timestamp, view_n( iter, n ) );
+                        iter += n;
+                        left -= n;
+                } while ( left != 0 );
+        }
+
+        void flush()
+        {
+                if ( good_ && std::fflush( file_ ) != 0 ) {
+                        good_ = false;
+                }
+        }
+
+        ~protocol_capture_writer()
+        {
+                if ( file_ != nullptr ) {
+                        std::fclose( file_ );
+                }
+        }
+
+private:
+        void record_chunk( std::chrono::nanoseconds timestamp, view< const uint8_t* > data )
+        {
+                using namespace detail;
+
+                std::array< uint8_t, capture_chunk_header_size > header;
+                capture_time_serializer::serialize_at(
+                    std::span< uint8_t, 8 >{ header.data(), 8 },
+                    static_cast< uint64_t >( timestamp.count() ) );
+                capture_size_serializer::serialize_at(
+                    std::span< uint8_t, 4 >{ header.data() + 8, 4 },
+                    static_cast< uint32_t >( data.size() ) );
+                write( header.data(), header.size() );
+                write( data.begin(), data.size() );
+        }
+
+        void write( const uint8_t* data, std::size_t n )
+        {
+                if ( good_ && std::fwrite( data, 1, n, file_ ) != n ) {
+                        good_ = false;
+                }
+        }
+
+        std::FILE*        file_;
+        clock::time_point start_;
+        bool              good_;
+};
+
+// Reads chunks of the capture from memory
+class protocol_capture_reader
+{
+public:
+        // Returns reader for the capture in `data`, or nullopt in case data do not start with the
+        // magic of capture file
+        static std::optional< protocol_capture_reader > make( view< const uint8_t* > data )
+        {
+                if ( data.size() < protocol_capture_magic.size() ||
+                     !std::equal(
+                         protocol_capture_magic.begin(),
+                         protocol_capture_magic.end(),
+                         data.begin() ) ) {
+                        return std::nullopt;
+                }
+                return protocol_capture_reader{ view_n(
+                    data.begin() + protocol_capture_magic.size(),
+                    data.size() - protocol_capture_magic.size() ) };
+        }
+
+        // Returns the next chunk, or nullopt at the end of the capture. Incomplete chunk at the end
+        // of the capture is ignored and reported by `truncated()`.
+        std::optional< protocol_capture_chunk > next()
+        {
+                using namespace detail;
+
+                std::size_t left = rest_.size();
+                if ( left < capture_chunk_header_size ) {
+                        truncated_ = left != 0;
+                        return std::nullopt;
+                }
+                const uint8_t* iter = rest_.begin();
+                uint64_t       time = capture_time_serializer::deserialize(
+                    capture_time_serializer::view_type::make_n< 8 >( iter ) );
+                uint32_t size = capture_size_serializer::deserialize(
+                    capture_size_serializer::view_type::make_n< 4 >( iter + 8 ) );
+                if ( left - capture_chunk_header_size < size ) {
+                        truncated_ = true;
+                        return std::nullopt;
+                }
+                const uint8_t* data = iter + capture_chunk_header_size;
+                rest_ = view_n( data + size, left - capture_chunk_header_size - size );
+                return protocol_capture_chunk{
+                    std::chrono::nanoseconds{ static_cast< int64_t >( time ) },
+                    view_n( data, size ) };
+        }
+
+        [[nodiscard]] bool truncated() const
+        {
+                return truncated_;
+        }
+
+private:
+        explicit protocol_capture_reader( view< const uint8_t* > rest )
+          : rest_( rest )
+        {
+        }
+
+        view< const uint8_t* > rest_;
+        bool                   truncated_ = false;
+};
+
+// Capture file mapped into memory for reading
+class protocol_capture_file
+{
+public:
+        explicit protocol_capture_file( const char* path )
+          : file_( path )
+        {
+        }
+
+        [[nodiscard]] bool is_open() const
+        {
+                return file_.is_open();
+        }
+
+        [[nodiscard]] view< const uint8_t* > data() const
+        {
+                return file_.data();
+        }
+
+        [[nodiscard]] std::optional< protocol_capture_reader > reader() const
+        {
+                return protocol_capture_reader::make( file_.data() );
+        }
+
+private:
+        mapped_file file_;
+};
+
+enum protocol_replay_timing_enum
+{
+        // chunks are loaded as fast as possible
+        PROTOCOL_REPLAY_MAX_THROUGHPUT,
+        // chunks are loaded with the same timing as they were captured
+        PROTOCOL_REPLAY_ORIGINAL_TIMING
+};
+
+struct protocol_replay_report
+{
+        using stats_type = protocol_stats<>;
+
+        std::size_t              chunks    = 0;
+        std::size_t              messages  = 0;
+        bool                     truncated = false;
+        std::chrono::nanoseconds elapsed{};
+
+        // events of the sequencer and errors of the handler
+        stats_type::snapshot_type stats;
+
+        [[nodiscard]] double messages_per_second() const
+        {
+                return static_cast< double >( messages ) / seconds();
+        }
+
+        [[nodiscard]] double bytes_per_second() const
+        {
+                return static_cast< double >( stats.bytes_loaded ) / seconds();
+        }
+
+private:
+        [[nodiscard]] double seconds() const
+        {
+                return std::chrono::duration< double >( elapsed ).count();
+        }
+};
+
+// Feeds the capture through the sequencer and the handler of `Packet`, each successfully extracted
+// value is passed to `f`.
+template < typename Packet, typename UnaryFunction >
+protocol_replay_report protocol_capture_replay(
+    protocol_capture_reader     reader,
+    protocol_replay_timing_enum timing,
+    UnaryFunction&&             f )
+{
+        using clock     = std::chrono::steady_clock;
+        using stats     = protocol_replay_report::stats_type;
+        using sequencer = typename Packet::template stats_view_sequencer< stats >;
+        using handler   = protocol_packet_handler< Packet >;
+
+        protocol_replay_report report;
+        sequencer              seq;
+
+        auto on_msg = [&]( const typename sequencer::view_type& msg ) {
+                auto res = [&] {
+                        if constexpr ( Packet::incremental_checksum ) {
+                                return handler::extract_sequenced( msg, seq.stats() );
+                        } else {
+                                return handler::extract( msg, seq.stats() );
+                        }
+                }();
+                res.match(
+                    [&]( const typename Packet::value_type& val ) {
+                            report.messages += 1;
+                            f( val );
+                    },
+                    [&]( const protocol_error_record& ) {} );
+        };
+
+        clock::time_point                         start = clock::now();
+        std::optional< std::chrono::nanoseconds > first_timestamp;
+        while ( std::optional< protocol_capture_chunk > chunk = reader.next() ) {
+                if ( timing == PROTOCOL_REPLAY_ORIGINAL_TIMING ) {
+                        if ( !first_timestamp ) {
+                                first_timestamp = chunk->timestamp;
+                        }
+                        std::this_thread::sleep_until(
+                            start + ( chunk->timestamp - *first_timestamp ) );
+                }
+                report.chunks += 1;
+                seq.load_view( chunk->data, on_msg );
+        }
+
+        report.elapsed   = clock::now() - start;
+        report.truncated = reader.truncated();
+        report.stats     = seq.stats().snapshot();
+        return report;
+}
+
+#ifdef EMLABCPP_USE_STREAMS
+
+inline std::ostream& operator<<( std::ostream& os, const protocol_replay_report& rep )
+{
+        os << "chunks: " << rep.chunks << ", bytes: " << rep.stats.bytes_loaded
+           << ", messages: " << rep.messages << ", frames: " << rep.stats.frames << "\n";
+        os << "decode rate: " << rep.messages_per_second() << " msg/s, " << rep.bytes_per_second()
+           << " B/s\n";
+        os << "discarded bytes: " << rep.stats.bytes_discarded
+           << ", checksum failures: " << rep.stats.checksum_failures << "\n";
+        for ( std::size_t i = 0; i < rep.stats.used_marks; i++ ) {
+                os << rep.stats.marks[i].mark << ": " << rep.stats.marks[i].count << "\n";
+        }
+        if ( rep.truncated ) {
+                os << "capture is truncated\n";
+        }
+        return os;
+}
+
+#endif
+
+}  // namespace emlabcpp
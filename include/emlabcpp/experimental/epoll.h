@@ -0,0 +1,194 @@
+#include <array>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Event loop over linux epoll that resumes coroutines once the file descriptors they wait for are
+// readable. Only one coroutine can wait for each file descriptor at a time. In case the epoll
+// instance can't be created, `is_open` is false and every wait fails. Coroutine destroyed while it
+// waits removes its registration, so it is never resumed afterwards.
+class epoll_loop
+{
+public:
+        class readable_awaiter
+        {
+        public:
+                readable_awaiter( epoll_loop& loop, int fd )
+                  : loop_( loop )
+                  , fd_( fd )
+                {
+                }
+
+                readable_awaiter( const readable_awaiter& )            = delete;
+                readable_awaiter& operator=( const readable_awaiter& ) = delete;
+
+                bool await_ready() const
+                {
+                        return false;
+                }
+
+                // The coroutine is not suspended in case the fd can't be registered, otherwise it
+                // would never be resumed
+                bool await_suspend( std::coroutine_handle<> h )
+                {
+                        registered_ = loop_.register_read( fd_, h );
+                        if ( registered_ ) {
+                                waiting_ = h;
+                        }
+                        return registered_;
+                }
+
+                // Returns false in case the wait for the fd failed
+                [[nodiscard]] bool await_resume()
+                {
+                        waiting_ = nullptr;
+                        return registered_;
+                }
+
+                // The awaiter is destroyed without being resumed only in case the suspended
+                // coroutine itself is destroyed
+                ~readable_awaiter()
+                {
+                        if ( waiting_ ) {
+                                loop_.cancel( fd_, waiting_ );
+                        }
+                }
+
+        private:
+                epoll_loop&             loop_;
+                int                     fd_;
+                bool                    registered_ = false;
+                std::coroutine_handle<> waiting_;
+        };
+
+        epoll_loop()
+          : fd_( epoll_create1( EPOLL_CLOEXEC ) )
+        {
+        }
+
+        epoll_loop( const epoll_loop& )            = delete;
+        epoll_loop& operator=( const epoll_loop& ) = delete;
+
+        [[nodiscard]] bool is_open() const
+        {
+                return fd_ >= 0;
+        }
+
+        // Awaitable that suspends the coroutine until `fd` is readable, `co_await` returns false in
+        // case the fd can't be waited for
+        readable_awaiter readable( int fd )
+        {
+                return readable_awaiter{ *this, fd };
+        }
+
+        // Waits up to `timeout_ms` for events and resumes the coroutines waiting for them. Returns
+        // the number of resumed coroutines.
+        std::size_t run_once( int timeout_ms )
+        {
+                int n = epoll_wait(
+                    fd_, events_.data(), static_cast< int >( events_.size() ), timeout_ms );
+                if ( n <= 0 ) {
+                        return 0;
+                }
+                std::size_t resumed = 0;
+                pending_            = static_cast< std::size_t >( n );
+                for ( next_ = 0; next_ < pending_; next_++ ) {
+                        void* addr = events_[next_].data.ptr;
+                        if ( addr == nullptr ) {
+                                continue;
+                        }
+                        std::coroutine_handle<>::from_address( addr ).resume();
+                        resumed += 1;
+                }
+                pending_ = 0;
+                return resumed;
+        }
+
+        ~epoll_loop()
+        {
+                if ( fd_ >= 0 ) {
+                        close( fd_ );
+                }
+        }
+
+private:
+        // The registration is one shot, the fd is disabled after the event until it is registered
+        // again. Returns false in case the fd can't be registered.
+        bool register_read( int fd, std::coroutine_handle<> h )
+        {
+                epoll_event ev{};
+                ev.events   = EPOLLIN | EPOLLONESHOT;
+                ev.data.ptr = h.address();
+                if ( epoll_ctl( fd_, EPOLL_CTL_MOD, fd, &ev ) == 0 ) {
+                        return true;
+                }
+                if ( errno != ENOENT ) {
+                        return false;
+                }
+                return epoll_ctl( fd_, EPOLL_CTL_ADD, fd, &ev ) == 0;
+        }
+
+        // Removes the registration of `fd` for coroutine `h` which is being destroyed, including
+        // its event that was already received by `run_once` but not yet processed.
+        void cancel( int fd, std::coroutine_handle<> h )
+        {
+                epoll_ctl( fd_, EPOLL_CTL_DEL, fd, nullptr );
+                for ( std::size_t i = next_ + 1; i < pending_; i++ ) {
+                        if ( events_[i].data.ptr == h.address() ) {
+                                events_[i].data.ptr = nullptr;
+                        }
+                }
+        }
+
+        int                           fd_;
+        std::array< epoll_event, 32 > events_;
+        std::size_t                   pending_ = 0;
+        std::size_t                   next_    = 0;
+};
+
+// Source of bytes for async_load that reads from file descriptor, which is switched to non-blocking
+// mode. The descriptor is not owned by the source.
+class epoll_fd_source
+{
+public:
+        epoll_fd_source( epoll_loop& loop, int fd )
+          : loop_( loop )
+          , fd_( fd )
+        {
+                fcntl( fd_, F_SETFL, fcntl( fd_, F_GETFL ) | O_NONBLOCK );
+        }
+
+        std::optional< std::size_t > read_some( std::span< uint8_t > buffer )
+        {
+                ssize_t res = ::read( fd_, buffer.data(), buffer.size() );
+                if ( res > 0 ) {
+                        return static_cast< std::size_t >( res );
+                }
+                if ( res < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ) ) {
+                        return 0;
+                }
+                return std::nullopt;
+        }
+
+        epoll_loop::readable_awaiter readable()
+        {
+                return loop_.readable( fd_ );
+        }
+
+private:
+        epoll_loop& loop_;
+        int         fd_;
+};
+
+}  // namespace emlabcpp
@@ -0,0 +1,65 @@
+#include "emlabcpp/view.h"
+
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Content of file mapped into memory for reading. In case the file could not be opened or mapped, or
+// it is empty, nothing is mapped and `data()` is empty view.
+class mapped_file
+{
+public:
+        explicit mapped_file( const char* path )
+          : fd_( open( path, O_RDONLY | O_CLOEXEC ) )
+        {
+                struct stat st;
+                if ( fd_ < 0 || fstat( fd_, &st ) != 0 || st.st_size == 0 ) {
+                        return;
+                }
+                auto  size = static_cast< std::size_t >( st.st_size );
+                void* addr = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0 );
+                if ( addr == MAP_FAILED ) {
+                        return;
+                }
+                data_   = view_n( static_cast< const uint8_t* >( addr ), size );
+                mapped_ = true;
+        }
+
+        mapped_file( const mapped_file& )            = delete;
+        mapped_file& operator=( const mapped_file& ) = delete;
+
+        [[nodiscard]] bool is_open() const
+        {
+                return mapped_;
+        }
+
+        [[nodiscard]] view< const uint8_t* > data() const
+        {
+                return data_;
+        }
+
+        ~mapped_file()
+        {
+                if ( mapped_ ) {
+                        munmap( const_cast< uint8_t* >( data_.begin() ), data_.size() );
+                }
+                if ( fd_ >= 0 ) {
+                        close( fd_ );
+                }
+        }
+
+private:
+        int                    fd_;
+        view< const uint8_t* > data_{};
+        bool                   mapped_ = false;
+};
+
+}  // namespace emlabcpp
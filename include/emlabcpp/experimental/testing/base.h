@@ -1,5 +1,6 @@
 #include "emlabcpp/static_vector.h"
 
+#include <algorithm>
 #include <map>
 #include <memory_resource>
 #include <variant>
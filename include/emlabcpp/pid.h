@@ -1,5 +1,7 @@
 #include "emlabcpp/algorithm.h"
 
+#include <algorithm>
+
 #pragma once
 
 namespace emlabcpp
@@ -0,0 +1,189 @@
+#include "emlabcpp/protocol/sequencer.h"
+
+#include <array>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <span>
+#include <utility>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Result of coroutine that produces `T`. The coroutine starts suspended and runs once the task is
+// awaited by other coroutine, or once `start()` is called for top level task. Awaiting coroutine is
+// resumed once the task finishes.
+template < typename T >
+class protocol_task
+{
+public:
+        struct promise_type
+        {
+                std::optional< T >      value;
+                std::coroutine_handle<> continuation;
+
+                protocol_task get_return_object()
+                {
+                        return protocol_task{ handle_type::from_promise( *this ) };
+                }
+
+                std::suspend_always initial_suspend() noexcept
+                {
+                        return {};
+                }
+
+                auto final_suspend() noexcept
+                {
+                        struct final_awaiter
+                        {
+                                bool await_ready() noexcept
+                                {
+                                        return false;
+                                }
+
+                                std::coroutine_handle<>
+                                await_suspend( std::coroutine_handle< promise_type > h ) noexcept
+                                {
+                                        std::coroutine_handle<> cont = h.promise().continuation;
+                                        return cont ? cont : std::noop_coroutine();
+                                }
+
+                                void await_resume() noexcept
+                                {
+                                }
+                        };
+                        return final_awaiter{};
+                }
+
+                void return_value( T val )
+                {
+                        value = std::move( val );
+                }
+
+                void unhandled_exception()
+                {
+                        std::terminate();
+                }
+        };
+
+        using handle_type = std::coroutine_handle< promise_type >;
+
+        protocol_task( const protocol_task& ) = delete;
+        protocol_task( protocol_task&& other ) noexcept
+          : h_( std::exchange( other.h_, nullptr ) )
+        {
+        }
+
+        protocol_task& operator=( const protocol_task& ) = delete;
+        protocol_task& operator=( protocol_task&& other ) noexcept
+        {
+                std::swap( h_, other.h_ );
+                return *this;
+        }
+
+        // Runs the coroutine until its first suspension, used for top level tasks that are not
+        // awaited.
+        void start()
+        {
+                h_.resume();
+        }
+
+        [[nodiscard]] bool done() const
+        {
+                return h_.done();
+        }
+
+        // Result of finished task
+        T& result()
+        {
+                return *h_.promise().value;
+        }
+
+        bool await_ready() const
+        {
+                return h_.done();
+        }
+
+        std::coroutine_handle<> await_suspend( std::coroutine_handle<> cont )
+        {
+                h_.promise().continuation = cont;
+                return h_;
+        }
+
+        T await_resume()
+        {
+                return std::move( *h_.promise().value );
+        }
+
+        ~protocol_task()
+        {
+                if ( h_ ) {
+                        h_.destroy();
+                }
+        }
+
+private:
+        explicit protocol_task( handle_type h )
+          : h_( h )
+        {
+        }
+
+        handle_type h_;
+};
+
+// Source of bytes for async_load. `read_some` reads available bytes without blocking and returns
+// their count, which is zero if no bytes are available, or returns nullopt once the source is
+// closed. `co_await source.readable()` suspends until bytes are available and returns false in case
+// the source can't be waited for.
+template < typename T >
+concept protocol_async_source = requires( T s, std::span< uint8_t > buffer )
+{
+        {
+                s.read_some( buffer )
+                } -> std::same_as< std::optional< std::size_t > >;
+        s.readable();
+};
+
+// Coroutine version of protocol_simple_load, loads bytes from the `source` into `Sequencer` until
+// a message is complete. Suspends whenever the source has no bytes available, so one thread can
+// wait for messages from many sources. Returns nullopt if the source is closed or can't be waited
+// for before the message is complete.
+template < typename Sequencer, protocol_async_source Source >
+protocol_task< std::optional< typename Sequencer::message_type > > async_load( Source& source )
+{
+        using message_type = typename Sequencer::message_type;
+
+        Sequencer                                   seq;
+        std::array< uint8_t, message_type::max_size > buffer;
+        std::size_t                                 to_read = Sequencer::fixed_size;
+        while ( true ) {
+                std::optional< std::size_t > opt_n =
+                    source.read_some( std::span{ buffer }.first( to_read ) );
+                if ( !opt_n ) {
+                        co_return std::nullopt;
+                }
+                if ( *opt_n == 0 ) {
+                        if ( !co_await source.readable() ) {
+                                co_return std::nullopt;
+                        }
+                        continue;
+                }
+
+                std::optional< message_type > res;
+                seq.load_data( view_n( buffer.begin(), *opt_n ) )
+                    .match(
+                        [&]( std::size_t next_read ) {
+                                to_read = next_read;
+                        },
+                        [&]( const message_type& msg ) {
+                                res = msg;
+                        } );
+                if ( res ) {
+                        co_return res;
+                }
+        }
+}
+
+}  // namespace emlabcpp
@@ -19,18 +19,18 @@ struct protocol_result
         std::size_t                             used = 0;
         std::variant< T, const protocol_mark* > res;
 
-        protocol_result() = default;
-        protocol_result( std::size_t u, std::variant< T, const protocol_mark* > v )
+        constexpr protocol_result() = default;
+        constexpr protocol_result( std::size_t u, std::variant< T, const protocol_mark* > v )
           : used( u )
           , res( v )
         {
         }
-        protocol_result( std::size_t u, T v )
+        constexpr protocol_result( std::size_t u, T v )
           : used( u )
           , res( v )
         {
         }
-        protocol_result( std::size_t u, const protocol_mark* m )
+        constexpr protocol_result( std::size_t u, const protocol_mark* m )
           : used( u )
           , res( m )
         {
@@ -89,6 +89,25 @@ struct protocol_offset
         using def_type               = D;
 };
 
+// Deserializes into view of up to N bytes of the source buffer instead of copying them. The bytes
+// are serialized in the same way as protocol_sizeless_message - greedily taking the rest of the
+// buffer. The deserialized view is valid only as long as the source buffer.
+template < std::size_t N >
+struct protocol_bytes_view
+{
+        static constexpr std::size_t max_size = N;
+};
+
+// Serialized in the same way as static_vector<D, N>, however the value is deserialized into
+// protocol_lazy_array that points into the source buffer and decodes items only when accessed. The
+// deserialized value is valid only as long as the source buffer.
+template < typename D, std::size_t N >
+struct protocol_array_view
+{
+        using value_type                      = D;
+        static constexpr std::size_t max_size = N;
+};
+
 // More complex constructs have custom mechanics that internally produces `def_type` alias used by
 // the library to serialize/deserialize it. Type inheriting htis class are handled as their
 // `def_type`.
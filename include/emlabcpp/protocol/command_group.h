@@ -57,6 +57,8 @@ struct protocol_command_group : protocol_def_type_base
             are_same_v< typename Cmds::id_type... >,
             "Each command of one group has to use same type of id" );
 
+        static constexpr protocol_endianess_enum endianess = Endianess;
+
         using cmds_type = std::tuple< Cmds... >;
         using def_type =
             protocol_endianess< Endianess, protocol_group< typename Cmds::def_type... > >;
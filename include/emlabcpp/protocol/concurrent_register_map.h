@@ -0,0 +1,211 @@
+#include "emlabcpp/algorithm.h"
+#include "emlabcpp/protocol/register_map.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+namespace detail
+{
+        // Value of one register stored in atomic words, so that it can be read while it is written
+        // without data race. Readers detect such read with the sequence counter, which is odd while
+        // the write is in progress.
+        template < typename T >
+        class seqlock_slot
+        {
+                static_assert( std::is_trivially_copyable_v< T > );
+
+        public:
+                using word_type                    = uint32_t;
+                static constexpr std::size_t words = ( sizeof( T ) + sizeof( word_type ) - 1 ) /
+                                                     sizeof( word_type );
+
+                static_assert( std::atomic< word_type >::is_always_lock_free );
+
+                std::atomic< uint32_t > seq{ 0 };
+
+                // Has to be called only by the writer between odd and even value of `seq`
+                void write( const T& val )
+                {
+                        std::array< word_type, words > buffer{};
+                        std::memcpy( buffer.data(), &val, sizeof( T ) );
+                        for ( std::size_t i = 0; i < words; i++ ) {
+                                data_[i].store( buffer[i], std::memory_order_relaxed );
+                        }
+                }
+
+                // The value may be torn, caller has to check `seq`
+                [[nodiscard]] T read() const
+                {
+                        std::array< word_type, words > buffer;
+                        for ( std::size_t i = 0; i < words; i++ ) {
+                                buffer[i] = data_[i].load( std::memory_order_relaxed );
+                        }
+                        std::array< std::byte, sizeof( T ) > bytes;
+                        std::memcpy( bytes.data(), buffer.data(), sizeof( T ) );
+                        return std::bit_cast< T >( bytes );
+                }
+
+        private:
+                std::array< std::atomic< word_type >, words > data_{};
+        };
+
+        template < typename Map, typename Sequence >
+        struct seqlock_slots_of;
+
+        template < typename Map, std::size_t... Is >
+        struct seqlock_slots_of< Map, std::index_sequence< Is... > >
+        {
+                using type = std::tuple< seqlock_slot< typename std::tuple_element_t<
+                    Is,
+                    typename Map::registers_tuple >::value_type >... >;
+        };
+}  // namespace detail
+
+// Register map shared between one writer thread and any number of reader threads without locks.
+// Each register is guarded by its own sequence counter and the whole map by another one:
+//  - `get_val` of a register retries only in case that register was written concurrently, so
+//    readers of big map are not disturbed by writes to unrelated registers
+//  - `snapshot` returns consistent copy of the whole map and retries in case any register was
+//    written during the copy
+// Readers never block the writer, but they spin while the writer modifies the values they read.
+// `set_val` and `store` have to be called only from one thread at a time.
+template < typename Map >
+class protocol_concurrent_register_map
+{
+public:
+        using map_type = Map;
+        using key_type = typename Map::key_type;
+
+        static constexpr std::size_t registers_count = Map::registers_count;
+
+        template < key_type Key >
+        using reg_value_type = typename Map::template reg_value_type< Key >;
+
+        protocol_concurrent_register_map()
+          : protocol_concurrent_register_map( Map{} )
+        {
+        }
+
+        explicit protocol_concurrent_register_map( const Map& m )
+        {
+                store( m );
+        }
+
+        protocol_concurrent_register_map( const protocol_concurrent_register_map& ) = delete;
+        protocol_concurrent_register_map&
+        operator=( const protocol_concurrent_register_map& ) = delete;
+
+        template < key_type Key >
+        void set_val( reg_value_type< Key > val )
+        {
+                auto& s = slot< Key >();
+                begin_write( s.seq );
+                s.write( val );
+                end_write( s.seq );
+                end_write( seq_ );
+        }
+
+        // Stores all registers of `m` at once, readers of snapshot see either the old or the new
+        // values of all registers
+        void store( const Map& m )
+        {
+                uint32_t s = seq_.load( std::memory_order_relaxed );
+                seq_.store( s + 1, std::memory_order_relaxed );
+                for_each_index< registers_count >( [&]< std::size_t i >() {
+                        static constexpr auto key  = Map::register_key( bounded_constant< i > );
+                        auto&                 reg  = std::get< i >( slots_ );
+                        uint32_t              rseq = reg.seq.load( std::memory_order_relaxed );
+                        reg.seq.store( rseq + 1, std::memory_order_relaxed );
+                        std::atomic_thread_fence( std::memory_order_release );
+                        reg.write( m.template get_val< key >() );
+                        reg.seq.store( rseq + 2, std::memory_order_release );
+                } );
+                end_write( seq_ );
+        }
+
+        template < key_type Key >
+        [[nodiscard]] reg_value_type< Key > get_val() const
+        {
+                const auto& s = slot< Key >();
+                while ( true ) {
+                        uint32_t before = s.seq.load( std::memory_order_acquire );
+                        if ( ( before & 1 ) != 0 ) {
+                                continue;
+                        }
+                        reg_value_type< Key > val = s.read();
+                        std::atomic_thread_fence( std::memory_order_acquire );
+                        if ( s.seq.load( std::memory_order_relaxed ) == before ) {
+                                return val;
+                        }
+                }
+        }
+
+        // Returns consistent copy of all registers
+        [[nodiscard]] Map snapshot() const
+        {
+                Map res;
+                while ( true ) {
+                        uint32_t before = seq_.load( std::memory_order_acquire );
+                        if ( ( before & 1 ) != 0 ) {
+                                continue;
+                        }
+                        for_each_index< registers_count >( [&]< std::size_t i >() {
+                                static constexpr auto key =
+                                    Map::register_key( bounded_constant< i > );
+                                res.template set_val< key >( std::get< i >( slots_ ).read() );
+                        } );
+                        std::atomic_thread_fence( std::memory_order_acquire );
+                        if ( seq_.load( std::memory_order_relaxed ) == before ) {
+                                return res;
+                        }
+                }
+        }
+
+private:
+        using slots_tuple = typename detail::
+            seqlock_slots_of< Map, std::make_index_sequence< registers_count > >::type;
+
+        template < key_type Key >
+        auto& slot()
+        {
+                return std::get< Map::template key_index< Key > >( slots_ );
+        }
+
+        template < key_type Key >
+        const auto& slot() const
+        {
+                return std::get< Map::template key_index< Key > >( slots_ );
+        }
+
+        // Marks both the map and the register as being written, the fence keeps the writes of the
+        // value after the odd counters
+        void begin_write( std::atomic< uint32_t >& reg_seq )
+        {
+                seq_.store( seq_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+                reg_seq.store(
+                    reg_seq.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+                std::atomic_thread_fence( std::memory_order_release );
+        }
+
+        static void end_write( std::atomic< uint32_t >& seq )
+        {
+                seq.store( seq.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+        }
+
+        std::atomic< uint32_t > seq_{ 0 };
+        slots_tuple             slots_;
+};
+
+}  // namespace emlabcpp
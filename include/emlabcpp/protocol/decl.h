@@ -1,5 +1,6 @@
 #include "emlabcpp/protocol/base.h"
 #include "emlabcpp/protocol/error.h"
+#include "emlabcpp/protocol/lazy_array.h"
 #include "emlabcpp/protocol/message.h"
 #include "emlabcpp/quantity.h"
 #include "emlabcpp/static_vector.h"
@@ -44,6 +45,20 @@ struct protocol_decl< D >
         static constexpr std::size_t min_size = max_size;
 };
 
+template < std::floating_point D >
+struct protocol_decl< D >
+{
+        using value_type                      = D;
+        static constexpr std::size_t max_size = sizeof( D );
+        static constexpr std::size_t min_size = max_size;
+};
+
+// Types whose serialized form is just the bytes of the value itself, possibly byte-swapped.
+// Continuous sequences of these can be serialized in bulk instead of item by item.
+template < typename T >
+concept protocol_bulk_type = protocol_declarable< T > && !std::same_as< T, bool > &&
+                             ( protocol_base_type< T > || std::floating_point< T > );
+
 template < protocol_declarable D, std::size_t N >
 struct protocol_decl< std::array< D, N > >
 {
@@ -91,6 +106,25 @@ struct protocol_decl< protocol_sizeless_message< N > >
         static constexpr std::size_t min_size = max_size;
 };
 
+template < std::size_t N >
+struct protocol_decl< protocol_bytes_view< N > >
+{
+        using value_type = view< const uint8_t* >;
+
+        static constexpr std::size_t max_size = N;
+        static constexpr std::size_t min_size = 0;
+};
+
+template < protocol_bulk_type D, std::size_t N >
+struct protocol_decl< protocol_array_view< D, N > >
+{
+        using value_type   = protocol_lazy_array< D >;
+        using counter_type = uint16_t;
+        static constexpr std::size_t max_size =
+            protocol_decl< counter_type >::max_size + protocol_decl< D >::max_size * N;
+        static constexpr std::size_t min_size = protocol_decl< counter_type >::min_size;
+};
+
 template < protocol_declarable D, auto Offset >
 struct protocol_decl< protocol_offset< D, Offset > >
 {
@@ -4,8 +4,11 @@
 #include "emlabcpp/either.h"
 #include "emlabcpp/iterators/numeric.h"
 #include "emlabcpp/protocol/decl.h"
+#include "emlabcpp/protocol/key_index.h"
 #include "emlabcpp/protocol/serializer.h"
 
+#include <limits>
+
 #pragma once
 
 namespace emlabcpp
@@ -70,6 +73,37 @@ struct protocol_def< D, Endianess >
         }
 };
 
+// Floating point values are serialized as bit pattern of unsigned integer of same size, this
+// follows the representation of IEEE 754 on the wire.
+template < std::floating_point D, protocol_endianess_enum Endianess >
+struct protocol_def< D, Endianess >
+{
+        using value_type                      = typename protocol_decl< D >::value_type;
+        static constexpr std::size_t max_size = protocol_decl< D >::max_size;
+
+        using word_type = select_utype_t< max_size >;
+        using sub_def   = protocol_def< word_type, Endianess >;
+        using size_type = typename sub_def::size_type;
+
+        static_assert( std::numeric_limits< D >::is_iec559 );
+
+        static constexpr size_type
+        serialize_at( std::span< uint8_t, max_size > buffer, value_type item )
+        {
+                return sub_def::serialize_at( buffer, std::bit_cast< word_type >( item ) );
+        }
+
+        static constexpr auto deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
+            -> protocol_result< value_type >
+        {
+                auto [used, res] = sub_def::deserialize( buffer );
+                if ( std::holds_alternative< const protocol_mark* >( res ) ) {
+                        return { used, *std::get_if< const protocol_mark* >( &res ) };
+                }
+                return { used, std::bit_cast< value_type >( *std::get_if< 0 >( &res ) ) };
+        }
+};
+
 template < protocol_declarable D, std::size_t N, protocol_endianess_enum Endianess >
 struct protocol_def< std::array< D, N >, Endianess >
 {
@@ -80,6 +114,10 @@ struct protocol_def< std::array< D, N >, Endianess >
         using sub_size_type = typename sub_def::size_type;
         using size_type     = bounded< std::size_t, sub_def::size_type::min_val * N, max_size >;
 
+        // Arrays of bulk types are fixedly sized, the view passed to deserialize has therefore
+        // always enough bytes for all items and the whole array is handled at once.
+        using bulk_serializer = protocol_bulk_serializer< D, Endianess >;
+
         // In both methods, we create the bounded size without properly checking that it the bounded
         // type was made properly (that is, that the provided std::size_t value is in the range).
         // Thas is ok as long as variant "we advanced the iter only by at max `sub_def::max_size`
@@ -88,6 +126,13 @@ struct protocol_def< std::array< D, N >, Endianess >
         static constexpr size_type
         serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
         {
+                if constexpr ( protocol_bulk_type< D > ) {
+                        if ( !std::is_constant_evaluated() ) {
+                                bulk_serializer::serialize_at( buffer.data(), item.data(), N );
+                                return size_type{};
+                        }
+                }
+
                 auto iter = buffer.begin();
 
                 for ( std::size_t i : range( N ) ) {
@@ -107,9 +152,16 @@ struct protocol_def< std::array< D, N >, Endianess >
         static constexpr auto deserialize( bounded_view< const uint8_t*, size_type > buffer )
             -> protocol_result< value_type >
         {
-                value_type  res{};
-                std::size_t offset = 0;
+                value_type res{};
+
+                if constexpr ( protocol_bulk_type< D > ) {
+                        if ( !std::is_constant_evaluated() ) {
+                                bulk_serializer::deserialize( buffer.begin(), res.data(), N );
+                                return protocol_result{ max_size, res };
+                        }
+                }
 
+                std::size_t offset = 0;
                 for ( std::size_t i : range( N ) ) {
                         auto opt_view = buffer.template opt_offset< sub_size_type >( offset );
 
@@ -223,76 +275,87 @@ struct protocol_def< std::variant< Ds... >, Endianess >
             std::min( { protocol_def< Ds, Endianess >::size_type::min_val... } );
         using size_type = bounded< std::size_t, min_size, max_size >;
 
+        using item_view_type = bounded_view<
+            const uint8_t*,
+            bounded< std::size_t, min_size - id_size, max_size - id_size > >;
+
+        // Both directions dispatch through tables of functions indexed by the id of the
+        // alternative, the cost does not depend on the number of alternatives.
+
+        template < std::size_t i >
+        static constexpr size_type
+        serialize_item( std::span< uint8_t, max_size > buffer, const value_type& item )
+        {
+                using sub_def =
+                    protocol_def< std::variant_alternative_t< i, def_type >, Endianess >;
+
+                // this also asserts that id has static serialized size
+                return bounded_constant< id_def::max_size > +
+                       sub_def::serialize_at(
+                           buffer.template subspan< id_def::max_size, sub_def::max_size >(),
+                           *std::get_if< i >( &item ) );
+        }
+
+        template < std::size_t i >
+        static constexpr auto deserialize_item( item_view_type item_view )
+            -> protocol_result< value_type >
+        {
+                using sub_def =
+                    protocol_def< std::variant_alternative_t< i, def_type >, Endianess >;
+
+                auto opt_view = item_view.template opt_offset< typename sub_def::size_type >( 0 );
+                if ( !opt_view ) {
+                        return { 0, &SIZE_ERR };
+                }
+
+                auto [sused, sres] = sub_def::deserialize( *opt_view );
+                if ( std::holds_alternative< const protocol_mark* >( sres ) ) {
+                        return { id_size + sused, *std::get_if< const protocol_mark* >( &sres ) };
+                }
+                return {
+                    id_size + sused,
+                    value_type{ std::in_place_index< i >, *std::get_if< 0 >( &sres ) } };
+        }
+
+        using serialize_fn   = size_type ( * )( std::span< uint8_t, max_size >, const value_type& );
+        using deserialize_fn = protocol_result< value_type > ( * )( item_view_type );
+
+        static constexpr auto serialize_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< serialize_fn, sizeof...( Ds ) >{ &serialize_item< Is >... };
+            }( std::index_sequence_for< Ds... >{} );
+
+        static constexpr auto deserialize_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< deserialize_fn, sizeof...( Ds ) >{
+                        &deserialize_item< Is >... };
+            }( std::index_sequence_for< Ds... >{} );
+
         static constexpr size_type
         serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
         {
                 id_def::serialize_at(
                     buffer.template first< id_size >(), static_cast< id_type >( item.index() ) );
 
-                std::optional< size_type > opt_res;
-                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
-                        if ( i != item.index() ) {
-                                return false;
-                        }
-                        using sub_def =
-                            protocol_def< std::variant_alternative_t< i, def_type >, Endianess >;
-
-                        // this also asserts that id has static serialized size
-                        opt_res =
-                            bounded_constant< id_def::max_size > +
-                            sub_def::serialize_at(
-                                buffer.template subspan< id_def::max_size, sub_def::max_size >(),
-                                std::get< i >( item ) );
-
-                        return true;
-                } );
-                // The only case in which this can fire is that iteration 0...sizeof...(Ds) above
-                // did not mathced item.index(), which should not be possible
-                EMLABCPP_ASSERT( opt_res );
-                return *opt_res;
+                // The index of valid variant is always in the range of the table
+                EMLABCPP_ASSERT( item.index() < sizeof...( Ds ) );
+                return serialize_table[item.index()]( buffer, item );
         }
 
         static constexpr auto deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
             -> protocol_result< value_type >
         {
-                protocol_result< value_type > res{ 0, &UNDEFVAR_ERR };
-
-                auto [used, idres] = id_def::deserialize( buffer.template first< id_size >() );
+                auto idres = id_def::deserialize( buffer.template first< id_size >() ).res;
                 if ( std::holds_alternative< const protocol_mark* >( idres ) ) {
-                        res.res = *std::get_if< const protocol_mark* >( &idres );
-                        return res;
+                        return { 0, *std::get_if< const protocol_mark* >( &idres ) };
                 }
                 id_type id = std::get< 0 >( idres );
 
-                auto item_view = buffer.template offset< id_size >();
-
-                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
-                        using D       = std::variant_alternative_t< i, def_type >;
-                        using sub_def = protocol_def< D, Endianess >;
-
-                        if ( id != i ) {
-                                return false;
-                        }
-
-                        auto opt_view =
-                            item_view.template opt_offset< typename sub_def::size_type >( 0 );
-
-                        if ( !opt_view ) {
-                                res.res = &SIZE_ERR;
-                                return true;
-                        }
-
-                        auto [sused, sres] = sub_def::deserialize( *opt_view );
-                        res.used           = used + sused;
-                        if ( std::holds_alternative< const protocol_mark* >( sres ) ) {
-                                res.res = *std::get_if< const protocol_mark* >( &sres );
-                        } else {
-                                res.res = value_type{ *std::get_if< 0 >( &sres ) };
-                        }
-                        return true;
-                } );
+                if ( id >= sizeof...( Ds ) ) {
+                        return { 0, &UNDEFVAR_ERR };
+                }
 
-                return res;
+                return deserialize_table[id]( buffer.template offset< id_size >() );
         }
 };
 
@@ -369,6 +432,84 @@ struct protocol_def< protocol_sizeless_message< N >, Endianess >
         }
 };
 
+template < std::size_t N, protocol_endianess_enum Endianess >
+struct protocol_def< protocol_bytes_view< N >, Endianess >
+{
+        using value_type = typename protocol_decl< protocol_bytes_view< N > >::value_type;
+        static constexpr std::size_t max_size = protocol_decl< protocol_bytes_view< N > >::max_size;
+        using size_type                       = bounded< std::size_t, 0, max_size >;
+
+        static constexpr size_type
+        serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
+        {
+                auto opt_bused = size_type::make( item.size() );
+                EMLABCPP_ASSERT( opt_bused );
+                std::copy( item.begin(), item.end(), buffer.begin() );
+                return *opt_bused;
+        }
+
+        static constexpr auto deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
+            -> protocol_result< value_type >
+        {
+                return { buffer.size(), value_type{ buffer.begin(), buffer.end() } };
+        }
+};
+
+template < protocol_bulk_type D, std::size_t N, protocol_endianess_enum Endianess >
+struct protocol_def< protocol_array_view< D, N >, Endianess >
+{
+        using decl       = protocol_decl< protocol_array_view< D, N > >;
+        using value_type = typename decl::value_type;
+
+        static_assert( N <= std::numeric_limits< uint16_t >::max() );
+
+        using counter_type = typename decl::counter_type;
+        using counter_def  = protocol_def< counter_type, Endianess >;
+        using sub_def      = protocol_def< D, Endianess >;
+
+        static constexpr std::size_t counter_size = counter_def::max_size;
+        static constexpr std::size_t item_size    = sub_def::max_size;
+
+        static constexpr std::size_t max_size = decl::max_size;
+        static constexpr std::size_t min_size = counter_size;
+        using size_type                       = bounded< std::size_t, min_size, max_size >;
+
+        static constexpr size_type
+        serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
+        {
+                EMLABCPP_ASSERT( item.size() <= N );
+                counter_def::serialize_at(
+                    buffer.template first< counter_size >(),
+                    static_cast< counter_type >( item.size() ) );
+                item.template serialize_at< Endianess >( buffer.data() + counter_size );
+
+                auto opt_bused = size_type::make( counter_size + item.size() * item_size );
+                EMLABCPP_ASSERT( opt_bused );
+                return *opt_bused;
+        }
+
+        static constexpr auto deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
+            -> protocol_result< value_type >
+        {
+                auto [cused, cres] =
+                    counter_def::deserialize( buffer.template first< counter_size >() );
+
+                if ( std::holds_alternative< const protocol_mark* >( cres ) ) {
+                        return { cused, *std::get_if< const protocol_mark* >( &cres ) };
+                }
+                std::size_t cnt       = *std::get_if< 0 >( &cres );
+                std::size_t available = ( buffer.size() - counter_size ) / item_size;
+                if ( cnt > available ) {
+                        return { counter_size + available * item_size, &SIZE_ERR };
+                }
+                std::size_t used = counter_size + cnt * item_size;
+                return {
+                    used,
+                    value_type{
+                        view_n( buffer.begin() + counter_size, cnt * item_size ), Endianess } };
+        }
+};
+
 template < protocol_declarable D, auto Offset, protocol_endianess_enum Endianess >
 struct protocol_def< protocol_offset< D, Offset >, Endianess >
 {
@@ -554,6 +695,32 @@ struct protocol_def< tag< V >, Endianess >
         }
 };
 
+// protocol_leading_tag<D> detects definitions that are tuples starting with tag<ID>, as produced
+// by protocol_command, and provides the ID.
+template < typename D >
+struct protocol_leading_tag
+{
+        static constexpr bool value = false;
+};
+
+template < auto ID, typename... Ds >
+struct protocol_leading_tag< std::tuple< tag< ID >, Ds... > >
+{
+        static constexpr bool value = true;
+        using id_type               = decltype( ID );
+        static constexpr id_type id = ID;
+};
+
+// protocol_tag_led_group<Ds...> is satisfied if each definition starts with tag<ID> of same type.
+// The IDs of such group have to be unique, so the first definition that can deserialize a message
+// is always the one with the ID at the beginning of the message.
+template < typename... Ds >
+concept protocol_tag_led_group =
+    sizeof...( Ds ) > 0 && ( protocol_leading_tag< Ds >::value && ... ) &&
+    are_same_v< typename protocol_leading_tag< Ds >::id_type... > &&
+    protocol_fixedly_sized< typename protocol_key_index< protocol_leading_tag< Ds >::id... >::
+                                key_type >;
+
 template < typename... Ds, protocol_endianess_enum Endianess >
 struct protocol_def< protocol_group< Ds... >, Endianess >
 {
@@ -565,61 +732,107 @@ struct protocol_def< protocol_group< Ds... >, Endianess >
         using def_variant = std::variant< Ds... >;
         using size_type   = bounded< std::size_t, min_size, max_size >;
 
+        static_assert(
+            [] {
+                    if constexpr ( protocol_tag_led_group< Ds... > ) {
+                            return protocol_key_index<
+                                protocol_leading_tag< Ds >::id... >::has_unique_keys();
+                    } else {
+                            return true;
+                    }
+            }(),
+            "Definitions of group that start with tag have to use unique ids" );
+
+        template < std::size_t i >
+        static constexpr size_type
+        serialize_item( std::span< uint8_t, max_size > buffer, const value_type& item )
+        {
+                using sub_def =
+                    protocol_def< std::variant_alternative_t< i, def_variant >, Endianess >;
+                return sub_def::serialize_at(
+                    buffer.template subspan< 0, sub_def::max_size >(), *std::get_if< i >( &item ) );
+        }
+
+        // Tries to deserialize definition `i` from the buffer, returns nothing if the definition
+        // does not match and next one should be tried.
+        template < std::size_t i >
+        static constexpr auto
+        deserialize_item( const bounded_view< const uint8_t*, size_type >& buffer )
+            -> std::optional< protocol_result< value_type > >
+        {
+                using sub_def =
+                    protocol_def< std::variant_alternative_t< i, def_variant >, Endianess >;
+
+                auto opt_view = bounded_view< const uint8_t*, typename sub_def::size_type >::make(
+                    view_n( buffer.begin(), min( sub_def::max_size, buffer.size() ) ) );
+
+                if ( !opt_view ) {
+                        return {};
+                }
+
+                auto [used, sres] = sub_def::deserialize( *opt_view );
+                if ( used == 0 ) {
+                        return {};
+                }
+
+                if ( std::holds_alternative< const protocol_mark* >( sres ) ) {
+                        return protocol_result< value_type >{
+                            used, *std::get_if< const protocol_mark* >( &sres ) };
+                }
+                return protocol_result< value_type >{
+                    used, value_type{ std::in_place_index< i >, *std::get_if< 0 >( &sres ) } };
+        }
+
+        using serialize_fn = size_type ( * )( std::span< uint8_t, max_size >, const value_type& );
+        using deserialize_fn = std::optional< protocol_result< value_type > > ( * )(
+            const bounded_view< const uint8_t*, size_type >& );
+
+        static constexpr auto serialize_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< serialize_fn, sizeof...( Ds ) >{ &serialize_item< Is >... };
+            }( std::index_sequence_for< Ds... >{} );
+
+        static constexpr auto deserialize_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< deserialize_fn, sizeof...( Ds ) >{
+                        &deserialize_item< Is >... };
+            }( std::index_sequence_for< Ds... >{} );
+
         static constexpr size_type
         serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
         {
-                std::optional< size_type > opt_res;
-                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
-                        if ( i != item.index() ) {
-                                return false;
-                        }
-                        using sub_def =
-                            protocol_def< std::variant_alternative_t< i, def_variant >, Endianess >;
-                        opt_res = sub_def::serialize_at(
-                            buffer.template subspan< 0, sub_def::max_size >(),
-                            std::get< i >( item ) );
-                        return true;
-                } );
                 // same check as for std::variant
-                EMLABCPP_ASSERT( opt_res );
-                return *opt_res;
+                EMLABCPP_ASSERT( item.index() < sizeof...( Ds ) );
+                return serialize_table[item.index()]( buffer, item );
         }
 
         static constexpr auto deserialize( const bounded_view< const uint8_t*, size_type >& buffer )
             -> protocol_result< value_type >
         {
-                std::size_t                                    offset = 0;
-                std::size_t                                    size   = buffer.size();
                 std::optional< protocol_result< value_type > > opt_res;
 
-                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
-                        using sub_def =
-                            protocol_def< std::variant_alternative_t< i, def_variant >, Endianess >;
-
-                        // TODO: this pattern repeats mutliple times here
-                        auto opt_view =
-                            bounded_view< const uint8_t*, typename sub_def::size_type >::make(
-                                view_n(
-                                    buffer.begin() + offset,
-                                    min( sub_def::max_size, size - offset ) ) );
-
-                        if ( !opt_view ) {
-                                return false;
-                        }
-
-                        auto [used, sres] = sub_def::deserialize( *opt_view );
-                        if ( used == 0 ) {
-                                return false;
+                if constexpr ( protocol_tag_led_group< Ds... > ) {
+                        // Only the definition with the id from the message can match, read the id
+                        // once and jump directly to it
+                        using index  = protocol_key_index< protocol_leading_tag< Ds >::id... >;
+                        using id_def = protocol_def< typename index::key_type, Endianess >;
+
+                        auto idres =
+                            id_def::deserialize( buffer.template first< id_def::max_size >() ).res;
+                        if ( std::holds_alternative< typename index::key_type >( idres ) ) {
+                                std::size_t i = index::find( *std::get_if< 0 >( &idres ) );
+                                if ( i != index::npos ) {
+                                        opt_res = deserialize_table[i]( buffer );
+                                }
                         }
-
-                        if ( std::holds_alternative< const protocol_mark* >( sres ) ) {
-                                opt_res.emplace(
-                                    used, *std::get_if< const protocol_mark* >( &sres ) );
-                        } else {
-                                opt_res.emplace( used, value_type{ *std::get_if< 0 >( &sres ) } );
+                } else {
+                        for ( deserialize_fn f : deserialize_table ) {
+                                opt_res = f( buffer );
+                                if ( opt_res ) {
+                                        break;
+                                }
                         }
-                        return true;
-                } );
+                }
 
                 if ( opt_res ) {
                         return *opt_res;
@@ -722,14 +935,27 @@ struct protocol_def< static_vector< T, N >, Endianess >
         static constexpr std::size_t min_size = counter_size;
         using size_type                       = bounded< std::size_t, min_size, max_size >;
 
+        using bulk_serializer = protocol_bulk_serializer< T, Endianess >;
+
         static constexpr size_type
-        serialize_at( std::span< uint8_t, max_size > buffer, value_type item )
+        serialize_at( std::span< uint8_t, max_size > buffer, const value_type& item )
         {
 
                 counter_def::serialize_at(
                     buffer.template first< counter_size >(),
                     static_cast< counter_type >( item.size() ) );
 
+                if constexpr ( protocol_bulk_type< T > ) {
+                        if ( !std::is_constant_evaluated() ) {
+                                bulk_serializer::serialize_at(
+                                    buffer.data() + counter_size, item.begin(), item.size() );
+                                auto opt_bused = size_type::make(
+                                    counter_size + item.size() * sub_def::max_size );
+                                EMLABCPP_ASSERT( opt_bused );
+                                return *opt_bused;
+                        }
+                }
+
                 // TODO: this duplicates std::array, generalize?
                 auto iter = buffer.begin() + counter_size;
                 for ( std::size_t i : range( item.size() ) ) {
@@ -760,6 +986,26 @@ struct protocol_def< static_vector< T, N >, Endianess >
                 std::size_t offset = counter_size;
                 value_type  res{};
 
+                // Size of the message is checked once for all items, the error offset matches the
+                // one reported by item-by-item deserialization.
+                if constexpr ( protocol_bulk_type< T > ) {
+                        if ( !std::is_constant_evaluated() ) {
+                                std::size_t available =
+                                    ( buffer.size() - offset ) / sub_def::max_size;
+                                if ( cnt > available ) {
+                                        return {
+                                            offset + available * sub_def::max_size, &SIZE_ERR };
+                                }
+                                for ( std::size_t i : range( cnt ) ) {
+                                        std::ignore = i;
+                                        res.emplace_back();
+                                }
+                                bulk_serializer::deserialize(
+                                    buffer.begin() + offset, res.begin(), cnt );
+                                return { offset + cnt * sub_def::max_size, res };
+                        }
+                }
+
                 for ( std::size_t i : range( cnt ) ) {
                         std::ignore = i;
 
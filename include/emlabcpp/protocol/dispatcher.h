@@ -0,0 +1,167 @@
+#include "emlabcpp/protocol/command_group.h"
+#include "emlabcpp/protocol/def.h"
+#include "emlabcpp/protocol/key_index.h"
+
+#include <optional>
+#include <tuple>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+namespace detail
+{
+        template < typename Cmds >
+        struct protocol_cmds_id_index;
+
+        template < typename... Cmds >
+        struct protocol_cmds_id_index< std::tuple< Cmds... > >
+        {
+                using type = protocol_key_index< Cmds::id... >;
+        };
+}  // namespace detail
+
+// Dispatcher decodes message of command group `Group` directly into call of the handler. It reads
+// the id of the command, finds the command in table indexed by the id and decodes its arguments
+// into local variables, with which `handler( tag< ID >{}, args... )` is called. This is equivalent
+// to extracting the std::variant of the group and visiting it with the handler, but the value of
+// the command is not constructed twice and the lookup does not depend on the number of commands.
+//
+// Handler has to be callable with each command of the group, overloaded functions or `matcher`
+// can be used for that. Errors are reported with the same marks and offsets as by extraction of the
+// group: message too short for the command it starts with or with unknown id is GROUP_ERR at
+// offset 0, error of an argument is reported with offset past the argument. The handler is not
+// called in case of error.
+template < typename Group, typename Handler >
+class protocol_dispatcher
+{
+public:
+        using group_type = Group;
+        using cmds_type  = typename Group::cmds_type;
+
+        static constexpr protocol_endianess_enum endianess  = Group::endianess;
+        static constexpr std::size_t             cmds_count = std::tuple_size_v< cmds_type >;
+
+        using id_type = typename std::tuple_element_t< 0, cmds_type >::id_type;
+        using id_def  = protocol_def< id_type, endianess >;
+
+        static std::optional< protocol_error_record >
+        dispatch( const view< const uint8_t* >& msg, Handler& h )
+        {
+                using id_view_type = bounded_view< const uint8_t*, typename id_def::size_type >;
+
+                if ( msg.size() < id_def::max_size ) {
+                        return protocol_error_record{ SIZE_ERR, 0 };
+                }
+                auto idres = id_def::deserialize(
+                                 id_view_type::template make_n< id_def::max_size >( msg.begin() ) )
+                                 .res;
+                if ( std::holds_alternative< const protocol_mark* >( idres ) ) {
+                        return protocol_error_record{
+                            **std::get_if< const protocol_mark* >( &idres ), 0 };
+                }
+                std::size_t i = id_index::find( *std::get_if< 0 >( &idres ) );
+                if ( i == id_index::npos ) {
+                        return protocol_error_record{ GROUP_ERR, 0 };
+                }
+                return dispatch_table[i]( msg, h );
+        }
+
+private:
+        using id_index = typename detail::protocol_cmds_id_index< cmds_type >::type;
+
+        using dispatch_fn = std::optional< protocol_error_record > ( * )(
+            const view< const uint8_t* >&, Handler& );
+
+        template < typename D >
+        using arg_type = typename protocol_decl< D >::value_type;
+
+        template < typename Def >
+        struct command_decoder;
+
+        template < auto ID, typename... Ds >
+        struct command_decoder< std::tuple< tag< ID >, Ds... > >
+        {
+                using args_type = std::tuple< arg_type< Ds >... >;
+                using def       = protocol_def< std::tuple< tag< ID >, Ds... >, endianess >;
+
+                static_assert(
+                    std::invocable< Handler&, tag< ID >, arg_type< Ds >... >,
+                    "Handler has to be callable with each command of the group" );
+
+                static std::optional< protocol_error_record >
+                dispatch( const view< const uint8_t* >& full_msg, Handler& h )
+                {
+                        // same as in the group, shorter message does not match the command and
+                        // bytes past the maximal size of the command are not considered
+                        if ( full_msg.size() < def::size_type::min_val ) {
+                                return protocol_error_record{ GROUP_ERR, 0 };
+                        }
+                        auto msg =
+                            view_n( full_msg.begin(), min( def::max_size, full_msg.size() ) );
+
+                        args_type                              args;
+                        std::size_t                            offset = id_def::max_size;
+                        std::optional< protocol_error_record > err;
+                        if ( !decode(
+                                 msg, offset, args, err, std::index_sequence_for< Ds... >{} ) ) {
+                                return err;
+                        }
+                        std::apply(
+                            [&]( auto&... vals ) {
+                                    h( tag< ID >{}, std::move( vals )... );
+                            },
+                            args );
+                        return {};
+                }
+
+                // Decodes the arguments one after another and stops at the first error
+                template < std::size_t... Is >
+                static bool decode(
+                    const view< const uint8_t* >&           msg,
+                    std::size_t&                            offset,
+                    args_type&                              args,
+                    std::optional< protocol_error_record >& err,
+                    std::index_sequence< Is... > )
+                {
+                        return (
+                            decode_arg< Ds >( msg, offset, std::get< Is >( args ), err ) && ... );
+                }
+        };
+
+        template < typename D >
+        static bool decode_arg(
+            const view< const uint8_t* >&           msg,
+            std::size_t&                            offset,
+            arg_type< D >&                          val,
+            std::optional< protocol_error_record >& err )
+        {
+                using def = protocol_def< D, endianess >;
+
+                auto opt_view = bounded_view< const uint8_t*, typename def::size_type >::make(
+                    view_n( msg.begin() + offset, min( def::max_size, msg.size() - offset ) ) );
+                if ( !opt_view ) {
+                        err = protocol_error_record{ SIZE_ERR, offset };
+                        return false;
+                }
+                auto [used, res] = def::deserialize( *opt_view );
+                if ( std::holds_alternative< const protocol_mark* >( res ) ) {
+                        err = protocol_error_record{
+                            **std::get_if< const protocol_mark* >( &res ), offset + used };
+                        return false;
+                }
+                val = std::move( *std::get_if< 0 >( &res ) );
+                offset += used;
+                return true;
+        }
+
+        static constexpr auto dispatch_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< dispatch_fn, cmds_count >{
+                        &command_decoder< typename std::tuple_element_t< Is, cmds_type >::
+                                              def_type >::dispatch... };
+            }( std::make_index_sequence< cmds_count >{} );
+};
+
+}  // namespace emlabcpp
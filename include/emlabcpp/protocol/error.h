@@ -22,6 +22,14 @@ struct protocol_error_record
         std::size_t   offset;
 };
 
+// Error of batch processing of multiple records, `index` is index of the record that failed and
+// offset of the `rec` is relative to the start of the record.
+struct protocol_batch_error_record
+{
+        protocol_error_record rec;
+        std::size_t           index;
+};
+
 // Creates protocol_mark from simple string literal.
 inline constexpr protocol_mark make_protocol_mark( const char ( &msg )[17] )
 {
@@ -46,5 +54,7 @@ static constexpr auto BADVAL_ERR = make_protocol_mark( "EMLABCPPBADVAL  " );
 static constexpr auto GROUP_ERR = make_protocol_mark( "EMLABCPPGRPMATCH" );
 // wrong checksum in the protocol
 static constexpr auto CHECKSUM_ERR = make_protocol_mark( "EMLABCPPCHECKSUM" );
+// key of register is not present in the register map
+static constexpr auto UNDEFKEY_ERR = make_protocol_mark( "EMLABCPPUNDEFKEY" );
 
 }  // namespace emlabcpp
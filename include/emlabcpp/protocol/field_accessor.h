@@ -0,0 +1,112 @@
+#include "emlabcpp/either.h"
+#include "emlabcpp/protocol/def.h"
+
+#pragma once
+
+namespace emlabcpp
+{
+
+namespace detail
+{
+        // Resolves the items of tuple definition `D` and the endianess they are serialized with, in
+        // the same way as protocol_def resolves them.
+        template < typename D, protocol_endianess_enum Endianess >
+        struct protocol_tuple_items;
+
+        template < typename... Ds, protocol_endianess_enum Endianess >
+        struct protocol_tuple_items< std::tuple< Ds... >, Endianess >
+        {
+                using type                                         = std::tuple< Ds... >;
+                static constexpr protocol_endianess_enum endianess = Endianess;
+        };
+
+        template <
+            protocol_endianess_enum Endianess,
+            typename D,
+            protocol_endianess_enum ParentEndianess >
+        struct protocol_tuple_items< protocol_endianess< Endianess, D >, ParentEndianess >
+          : protocol_tuple_items< D, Endianess >
+        {
+        };
+
+        template <
+            std::derived_from< protocol_def_type_base > D,
+            protocol_endianess_enum                     Endianess >
+        struct protocol_tuple_items< D, Endianess >
+          : protocol_tuple_items< typename D::def_type, Endianess >
+        {
+        };
+}  // namespace detail
+
+// protocol_field_accessor< Def > provides access to single items of serialized tuple definition
+// (std::tuple or protocol_tuple) without deserializing the entire message. The offset of item `I`
+// is computed at compile time, which requires all items up to and including `I` to be fixedly
+// sized.
+template < protocol_declarable Def, protocol_endianess_enum Endianess = PROTOCOL_BIG_ENDIAN >
+struct protocol_field_accessor
+{
+        using items_type = typename detail::protocol_tuple_items< Def, Endianess >::type;
+        static constexpr protocol_endianess_enum endianess =
+            detail::protocol_tuple_items< Def, Endianess >::endianess;
+
+        template < std::size_t I >
+        using item_def = protocol_def< std::tuple_element_t< I, items_type >, endianess >;
+
+        template < std::size_t I >
+        using item_value_type = typename item_def< I >::value_type;
+
+        template < std::size_t I >
+        static constexpr std::size_t offset = [] {
+                std::size_t res = 0;
+                for_each_index< I + 1 >( [&]< std::size_t j >() {
+                        using D = std::tuple_element_t< j, items_type >;
+                        static_assert(
+                            protocol_fixedly_sized< D >,
+                            "Fields up to the accessed one have to be fixedly sized" );
+                        if ( j != I ) {
+                                res += protocol_decl< D >::max_size;
+                        }
+                } );
+                return res;
+        }();
+
+        template < std::size_t I >
+        static either< item_value_type< I >, protocol_error_record >
+        get( const view< const uint8_t* >& msg )
+        {
+                using sub_def = item_def< I >;
+
+                if ( msg.size() < offset< I > + sub_def::max_size ) {
+                        return protocol_error_record{ SIZE_ERR, offset< I > };
+                }
+                auto opt_view = bounded_view< const uint8_t*, typename sub_def::size_type >::make(
+                    view_n( msg.begin() + offset< I >, sub_def::max_size ) );
+                EMLABCPP_ASSERT( opt_view );
+
+                auto [used, res] = sub_def::deserialize( *opt_view );
+                if ( std::holds_alternative< const protocol_mark* >( res ) ) {
+                        return protocol_error_record{ *std::get< 1 >( res ), offset< I > + used };
+                }
+                return std::get< 0 >( res );
+        }
+
+        // Overwrites value of item `I` in the message, message has to be big enough to contain
+        // the item.
+        template < std::size_t I >
+        static std::optional< protocol_error_record >
+        set( protocol_message_derived auto& msg, const item_value_type< I >& val )
+        {
+                using sub_def = item_def< I >;
+
+                if ( msg.size() < offset< I > + sub_def::max_size ) {
+                        return protocol_error_record{ SIZE_ERR, offset< I > };
+                }
+                sub_def::serialize_at(
+                    std::span< uint8_t, sub_def::max_size >{
+                        msg.begin() + offset< I >, sub_def::max_size },
+                    val );
+                return {};
+        }
+};
+
+}  // namespace emlabcpp
@@ -1,5 +1,6 @@
 #include "emlabcpp/either.h"
 #include "emlabcpp/protocol/def.h"
+#include "emlabcpp/protocol/iterator_serializer.h"
 
 #pragma once
 
@@ -20,13 +21,34 @@ struct protocol_handler
 
         static message_type serialize( value_type val )
         {
-                std::array< uint8_t, def::max_size > buffer{};
-
-                bounded used = def::serialize_at( buffer, val );
-                EMLABCPP_ASSERT( *used <= def::max_size );
-                return *message_type::make( view_n( buffer.begin(), *used ) );
+                return message_type::make_with( [&]( std::span< uint8_t, def::max_size > buffer ) {
+                        bounded used = def::serialize_at( buffer, val );
+                        return *used;
+                } );
         };
 
+        // Serializes the value directly into the buffer and returns number of bytes used. The
+        // definition serializes into buffer of `def::max_size` bytes, so the buffer has to have
+        // at least that size even if the value needs less bytes, nothing is returned otherwise.
+        static std::optional< std::size_t >
+        serialize_into( std::span< uint8_t > buffer, const value_type& val )
+        {
+                if ( buffer.size() < def::max_size ) {
+                        return {};
+                }
+                bounded used = def::serialize_at( buffer.template first< def::max_size >(), val );
+                return *used;
+        }
+
+        // Serializes the value into the output iterator and returns the iterator past the last
+        // written byte, see protocol_iterator_serializer.
+        template < std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize_into( OutputIterator out, const value_type& val )
+        {
+                using serializer = protocol_iterator_serializer< T, PROTOCOL_BIG_ENDIAN >;
+                return serializer::serialize( out, val );
+        }
+
         static either< value_type, protocol_error_record >
         extract( const view< const uint8_t* >& msg )
         {
@@ -41,6 +63,79 @@ struct protocol_handler
                 }
                 return std::get< 0 >( res );
         }
+
+        // Serializes each value of the range into the output iterator, one record after another.
+        // Returns the iterator past the last written byte.
+        template < std::ranges::input_range Range, std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize_many( const Range& vals, OutputIterator out )
+        {
+                for ( const value_type& val : vals ) {
+                        out = serialize_into( out, val );
+                }
+                return out;
+        }
+
+        // Extracts records stored back to back in the buffer into the output iterator. Returns
+        // number of extracted records, or the first error and index of the record that caused it.
+        // Records preceding the failed one are already stored in the output. For fixedly sized
+        // definitions the number of complete records is computed once and they are extracted
+        // without any size checks, incomplete record at the end of the buffer is reported as
+        // SIZE_ERR after them.
+        template < std::output_iterator< value_type > OutputIterator >
+        static either< std::size_t, protocol_batch_error_record >
+        extract_many( std::span< const uint8_t > buffer, OutputIterator out )
+        {
+                static_assert(
+                    def::size_type::min_val > 0, "Each record has to use at least one byte" );
+
+                using bview_type = bounded_view< const uint8_t*, typename def::size_type >;
+
+                if constexpr ( protocol_fixedly_sized< T > ) {
+                        std::size_t count = buffer.size() / def::max_size;
+                        for ( std::size_t i = 0; i < count; i++ ) {
+                                const uint8_t* start = buffer.data() + i * def::max_size;
+                                auto           res   = def::deserialize(
+                                    bview_type::template make_n< def::max_size >( start ) );
+                                if ( std::holds_alternative< const protocol_mark* >( res.res ) ) {
+                                        const protocol_mark* mark =
+                                            *std::get_if< const protocol_mark* >( &res.res );
+                                        return protocol_batch_error_record{
+                                            { *mark, res.used }, i };
+                                }
+                                *out = std::move( *std::get_if< 0 >( &res.res ) );
+                                ++out;
+                        }
+                        std::size_t rest = buffer.size() % def::max_size;
+                        if ( rest != 0 ) {
+                                return protocol_batch_error_record{ { SIZE_ERR, rest }, count };
+                        }
+                        return count;
+                } else {
+                        std::size_t count  = 0;
+                        std::size_t offset = 0;
+                        while ( offset != buffer.size() ) {
+                                auto opt_view = bview_type::make( view_n(
+                                    buffer.data() + offset,
+                                    min( def::max_size, buffer.size() - offset ) ) );
+                                if ( !opt_view ) {
+                                        return protocol_batch_error_record{
+                                            { SIZE_ERR, 0 }, count };
+                                }
+                                auto res = def::deserialize( *opt_view );
+                                if ( std::holds_alternative< const protocol_mark* >( res.res ) ) {
+                                        const protocol_mark* mark =
+                                            *std::get_if< const protocol_mark* >( &res.res );
+                                        return protocol_batch_error_record{
+                                            { *mark, res.used }, count };
+                                }
+                                *out = std::move( *std::get_if< 0 >( &res.res ) );
+                                ++out;
+                                ++count;
+                                offset += res.used;
+                        }
+                        return count;
+                }
+        }
 };
 
 }  // namespace emlabcpp
@@ -0,0 +1,104 @@
+#include "emlabcpp/algorithm.h"
+#include "emlabcpp/protocol/def.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <tuple>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// protocol_iterator_serializer<D,E> serializes value of definition D byte by byte into an output
+// iterator, which can't be viewed as span as protocol_def<D,E> requires. Tuples, arrays, groups
+// and definitions wrapping other definitions are walked item by item, so only the leaf items are
+// serialized into buffer on stack before they are copied into the iterator. The buffer therefore
+// has the size of the largest leaf item rather than the size of the whole message.
+template < typename D, protocol_endianess_enum Endianess >
+struct protocol_iterator_serializer
+{
+        using def        = protocol_def< D, Endianess >;
+        using value_type = typename def::value_type;
+
+        template < std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize( OutputIterator out, const value_type& val )
+        {
+                std::array< uint8_t, def::max_size > buffer;
+                bounded used = def::serialize_at( buffer, val );
+                return std::copy_n( buffer.begin(), *used, out );
+        }
+};
+
+template < protocol_declarable D, std::size_t N, protocol_endianess_enum Endianess >
+struct protocol_iterator_serializer< std::array< D, N >, Endianess >
+{
+        using sub_serializer = protocol_iterator_serializer< D, Endianess >;
+        using value_type     = typename protocol_def< std::array< D, N >, Endianess >::value_type;
+
+        template < std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize( OutputIterator out, const value_type& val )
+        {
+                for ( const auto& item : val ) {
+                        out = sub_serializer::serialize( out, item );
+                }
+                return out;
+        }
+};
+
+template < protocol_declarable... Ds, protocol_endianess_enum Endianess >
+struct protocol_iterator_serializer< std::tuple< Ds... >, Endianess >
+{
+        using value_type = typename protocol_def< std::tuple< Ds... >, Endianess >::value_type;
+
+        template < std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize( OutputIterator out, const value_type& val )
+        {
+                for_each_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
+                        using sub_serializer = protocol_iterator_serializer<
+                            std::tuple_element_t< i, std::tuple< Ds... > >,
+                            Endianess >;
+                        out = sub_serializer::serialize( out, std::get< i >( val ) );
+                } );
+                return out;
+        }
+};
+
+template < typename... Ds, protocol_endianess_enum Endianess >
+struct protocol_iterator_serializer< protocol_group< Ds... >, Endianess >
+{
+        using value_type = typename protocol_def< protocol_group< Ds... >, Endianess >::value_type;
+
+        template < std::output_iterator< uint8_t > OutputIterator >
+        static OutputIterator serialize( OutputIterator out, const value_type& val )
+        {
+                // same check as in the definition of the group
+                EMLABCPP_ASSERT( val.index() < sizeof...( Ds ) );
+                until_index< sizeof...( Ds ) >( [&]< std::size_t i >() {
+                        if ( val.index() != i ) {
+                                return false;
+                        }
+                        using sub_serializer = protocol_iterator_serializer<
+                            std::tuple_element_t< i, std::tuple< Ds... > >,
+                            Endianess >;
+                        out = sub_serializer::serialize( out, *std::get_if< i >( &val ) );
+                        return true;
+                } );
+                return out;
+        }
+};
+
+template < protocol_endianess_enum Endianess, typename D, protocol_endianess_enum ParentEndianess >
+struct protocol_iterator_serializer< protocol_endianess< Endianess, D >, ParentEndianess >
+  : protocol_iterator_serializer< D, Endianess >
+{
+};
+
+template < std::derived_from< protocol_def_type_base > D, protocol_endianess_enum Endianess >
+struct protocol_iterator_serializer< D, Endianess >
+  : protocol_iterator_serializer< typename D::def_type, Endianess >
+{
+};
+
+}  // namespace emlabcpp
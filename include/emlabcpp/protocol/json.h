@@ -131,6 +131,24 @@ struct protocol_json_serializer< int64_t > : protocol_json_serializer_base
                 return std::string{ type_name };
         }
 };
+template <>
+struct protocol_json_serializer< float > : protocol_json_serializer_base
+{
+        static constexpr std::string_view type_name = "float";
+        static std::string                get_name()
+        {
+                return std::string{ type_name };
+        }
+};
+template <>
+struct protocol_json_serializer< double > : protocol_json_serializer_base
+{
+        static constexpr std::string_view type_name = "double";
+        static std::string                get_name()
+        {
+                return std::string{ type_name };
+        }
+};
 template < protocol_declarable T >
 requires( std::is_enum_v< T > ) struct protocol_json_serializer< T > : protocol_json_serializer_base
 {
@@ -235,6 +253,31 @@ struct protocol_json_serializer< protocol_sizeless_message< N > > : protocol_jso
         static constexpr std::string_view type_name = "sizeless_message";
 };
 
+template < std::size_t N >
+struct protocol_json_serializer< protocol_bytes_view< N > > : protocol_json_serializer_base
+{
+        static constexpr std::string_view type_name = "bytes_view";
+};
+
+template < protocol_declarable D, std::size_t N >
+struct protocol_json_serializer< protocol_array_view< D, N > > : protocol_json_serializer_base
+{
+        static constexpr std::string_view type_name = "array_view";
+        using sub_ser                               = protocol_json_serializer< D >;
+
+        static std::string get_name()
+        {
+                return sub_ser::get_name() + "[" + std::to_string( N ) + "]";
+        }
+
+        static void add_extra( nlohmann::json& j )
+        {
+                j["counter_type"] = protocol_decl<
+                    typename protocol_decl< protocol_array_view< D, N > >::counter_type >{};
+                j["sub_type"] = protocol_decl< D >{};
+        }
+};
+
 template < protocol_declarable D, auto Offset >
 struct protocol_json_serializer< protocol_offset< D, Offset > > : protocol_json_serializer_base
 {
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Table that maps keys, such as keys of registers or ids of commands, to their index in the list
+// of keys, so the runtime lookup does not depend on the number of keys. Keys that cover small range
+// of values are looked up in array indexed directly by the key, other integer or enum keys are
+// found by binary search in array sorted by the key. Keys of other types are compared one by one.
+// In case of duplicate keys, the first one is found.
+template < auto... Keys >
+struct protocol_key_index
+{
+        using key_type = std::tuple_element_t< 0, std::tuple< decltype( Keys )... > >;
+        using raw_type = typename std::conditional_t<
+            std::is_enum_v< key_type >,
+            std::underlying_type< key_type >,
+            std::type_identity< key_type > >::type;
+
+        static constexpr std::size_t count = sizeof...( Keys );
+        // index returned for keys that are not in the table
+        static constexpr std::size_t npos = count;
+
+        static constexpr std::size_t find( key_type key )
+        {
+                if constexpr ( !std::is_integral_v< raw_type > ) {
+                        return find_linear( key );
+                } else if constexpr ( dense ) {
+                        return find_direct( key );
+                } else {
+                        return find_sorted( key );
+                }
+        }
+
+        static constexpr bool has_unique_keys()
+        {
+                for ( std::size_t i = 0; i < count; i++ ) {
+                        for ( std::size_t j = i + 1; j < count; j++ ) {
+                                if ( keys[i] == keys[j] ) {
+                                        return false;
+                                }
+                        }
+                }
+                return true;
+        }
+
+private:
+        // smallest type that can hold all indexes and npos
+        using index_type = std::conditional_t<
+            ( count < std::numeric_limits< uint8_t >::max() ),
+            uint8_t,
+            std::conditional_t<
+                ( count < std::numeric_limits< uint16_t >::max() ),
+                uint16_t,
+                std::size_t > >;
+
+        static constexpr std::array< key_type, count > keys = { Keys... };
+
+        static constexpr std::size_t find_linear( key_type key )
+        {
+                return static_cast< std::size_t >(
+                    std::distance( keys.begin(), std::find( keys.begin(), keys.end(), key ) ) );
+        }
+
+        static constexpr raw_type min_raw()
+        {
+                return static_cast< raw_type >( *std::min_element( keys.begin(), keys.end() ) );
+        }
+
+        static constexpr raw_type max_raw()
+        {
+                return static_cast< raw_type >( *std::max_element( keys.begin(), keys.end() ) );
+        }
+
+        // Distance of the key from the smallest key, computed in unsigned type so that it does not
+        // overflow for signed keys
+        static constexpr std::size_t offset_of( raw_type raw )
+        {
+                using unsigned_type = std::make_unsigned_t< raw_type >;
+                return static_cast< unsigned_type >(
+                    static_cast< unsigned_type >( raw ) -
+                    static_cast< unsigned_type >( min_raw() ) );
+        }
+
+        // direct table is used in case it has at most four items per key, the distance of the
+        // largest key is compared so that the size of the table can't overflow for keys covering
+        // whole range of the type
+        static constexpr bool dense = [] {
+                if constexpr ( std::is_integral_v< raw_type > ) {
+                        return offset_of( max_raw() ) < 4 * count;
+                } else {
+                        return false;
+                }
+        }();
+
+        static constexpr std::size_t range = [] {
+                if constexpr ( dense ) {
+                        return offset_of( max_raw() ) + 1;
+                } else {
+                        return std::size_t{ 0 };
+                }
+        }();
+
+        static constexpr auto direct = [] {
+                std::array< index_type, dense ? range : 0 > res{};
+                if constexpr ( dense ) {
+                        std::fill( res.begin(), res.end(), static_cast< index_type >( npos ) );
+                        for ( std::size_t i = count; i > 0; i-- ) {
+                                raw_type raw = static_cast< raw_type >( keys[i - 1] );
+                                res[offset_of( raw )] = static_cast< index_type >( i - 1 );
+                        }
+                }
+                return res;
+        }();
+
+        static constexpr std::size_t find_direct( key_type key )
+        {
+                std::size_t off = offset_of( static_cast< raw_type >( key ) );
+                if ( off >= range ) {
+                        return npos;
+                }
+                return direct[off];
+        }
+
+        struct entry
+        {
+                raw_type   raw;
+                index_type index;
+        };
+
+        static constexpr auto sorted = [] {
+                std::array< entry, count > res{};
+                if constexpr ( std::is_integral_v< raw_type > ) {
+                        for ( std::size_t i = 0; i < count; i++ ) {
+                                res[i] = entry{
+                                    static_cast< raw_type >( keys[i] ),
+                                    static_cast< index_type >( i ) };
+                        }
+                        // entries with same key are ordered by index, so the first one is found
+                        std::sort( res.begin(), res.end(), []( const entry& lh, const entry& rh ) {
+                                if ( lh.raw != rh.raw ) {
+                                        return lh.raw < rh.raw;
+                                }
+                                return lh.index < rh.index;
+                        } );
+                }
+                return res;
+        }();
+
+        static constexpr std::size_t find_sorted( key_type key )
+        {
+                auto raw  = static_cast< raw_type >( key );
+                auto iter = std::lower_bound(
+                    sorted.begin(), sorted.end(), raw, []( const entry& e, raw_type val ) {
+                            return e.raw < val;
+                    } );
+                if ( iter == sorted.end() || iter->raw != raw ) {
+                        return npos;
+                }
+                return iter->index;
+        }
+};
+
+}  // namespace emlabcpp
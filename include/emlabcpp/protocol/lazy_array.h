@@ -0,0 +1,96 @@
+#include "emlabcpp/protocol/serializer.h"
+#include "emlabcpp/view.h"
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Read-only array of items of type D that are stored in serialized form in a buffer owned by
+// somebody else. Items are decoded with the stored endianess only when they are accessed, the
+// instance is valid only as long as the underlying buffer exists.
+template < typename D >
+class protocol_lazy_array
+{
+public:
+        using value_type                       = D;
+        static constexpr std::size_t item_size = sizeof( D );
+
+        protocol_lazy_array() = default;
+
+        protocol_lazy_array( view< const uint8_t* > data, protocol_endianess_enum endianess )
+          : data_( data )
+          , endianess_( endianess )
+        {
+        }
+
+        [[nodiscard]] std::size_t size() const
+        {
+                return data_.size() / item_size;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+                return data_.empty();
+        }
+
+        [[nodiscard]] protocol_endianess_enum endianess() const
+        {
+                return endianess_;
+        }
+
+        // Serialized form of the items.
+        [[nodiscard]] view< const uint8_t* > raw() const
+        {
+                return data_;
+        }
+
+        D operator[]( std::size_t i ) const
+        {
+                D res;
+                const uint8_t* source = data_.begin() + i * item_size;
+                if ( endianess_ == PROTOCOL_BIG_ENDIAN ) {
+                        protocol_bulk_serializer< D, PROTOCOL_BIG_ENDIAN >::deserialize(
+                            source, &res, 1 );
+                } else {
+                        protocol_bulk_serializer< D, PROTOCOL_LITTLE_ENDIAN >::deserialize(
+                            source, &res, 1 );
+                }
+                return res;
+        }
+
+        // Serializes all items into `target` with endianess `Endianess`, this is simple copy if the
+        // endianess matches.
+        template < protocol_endianess_enum Endianess >
+        void serialize_at( uint8_t* target ) const
+        {
+                if ( endianess_ == Endianess ) {
+                        std::copy( data_.begin(), data_.end(), target );
+                        return;
+                }
+                for ( std::size_t i : range( size() ) ) {
+                        D item = ( *this )[i];
+                        protocol_bulk_serializer< D, Endianess >::serialize_at(
+                            target + i * item_size, &item, 1 );
+                }
+        }
+
+        friend bool operator==( const protocol_lazy_array& lh, const protocol_lazy_array& rh )
+        {
+                if ( lh.size() != rh.size() ) {
+                        return false;
+                }
+                for ( std::size_t i : range( lh.size() ) ) {
+                        if ( lh[i] != rh[i] ) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+private:
+        view< const uint8_t* >  data_;
+        protocol_endianess_enum endianess_ = PROTOCOL_BIG_ENDIAN;
+};
+
+}  // namespace emlabcpp
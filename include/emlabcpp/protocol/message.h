@@ -1,8 +1,10 @@
+#include "emlabcpp/assert.h"
 #include "emlabcpp/concepts.h"
 #include "emlabcpp/view.h"
 
 #include <array>
 #include <optional>
+#include <span>
 
 #pragma once
 
@@ -30,6 +32,17 @@ public:
                 return { protocol_message( cont.begin(), cont.end() ) };
         }
 
+        // Creates message by passing its storage to `f`, which writes the content directly into it
+        // and returns how many bytes were used.
+        template < typename UnaryFunction >
+        static protocol_message make_with( UnaryFunction&& f )
+        {
+                protocol_message res;
+                res.used_ = f( std::span< uint8_t, N >{ res.data_ } );
+                EMLABCPP_ASSERT( res.used_ <= N );
+                return res;
+        }
+
         protocol_message() = default;
 
         template < std::size_t M >
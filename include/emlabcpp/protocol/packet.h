@@ -1,3 +1,4 @@
+#include "emlabcpp/crc.h"
 #include "emlabcpp/protocol/sequencer.h"
 #include "emlabcpp/protocol/serializer.h"
 #include "emlabcpp/protocol/tuple.h"
@@ -18,6 +19,57 @@ concept protocol_packet_def = requires( T t )
         protocol_declarable< typename T::checksum_type >;
 };
 
+// Packet definition that also provides the checksum incrementally: `checksum_init` creates the
+// state, `checksum_update` adds bytes to it and `checksum_finalize` returns the checksum. With
+// these, the sequencer of the packet checks the checksum of messages as their bytes arrive.
+template < typename T >
+concept protocol_packet_incremental_def = protocol_packet_def< T > &&
+    requires( typename T::checksum_state state, view< const uint8_t* > data )
+{
+        {
+                T::checksum_init()
+                } -> std::same_as< typename T::checksum_state >;
+        {
+                T::checksum_update( state, data )
+                } -> std::same_as< typename T::checksum_state >;
+        {
+                T::checksum_finalize( state )
+                } -> std::same_as< typename T::checksum_type >;
+};
+
+// Provides the checksum part of protocol_packet_def, with checksum calculated as `Crc` from crc.h.
+// Inherit from this in the definition of the packet:
+//
+// struct my_packet_def : protocol_packet_crc< crc32c >
+// { ... };
+template < typename Crc >
+struct protocol_packet_crc
+{
+        using checksum_type  = typename Crc::value_type;
+        using checksum_state = typename Crc::value_type;
+
+        static constexpr checksum_type get_checksum( const view< const uint8_t* > mview )
+        {
+                return Crc::compute( mview );
+        }
+
+        static constexpr checksum_state checksum_init()
+        {
+                return Crc::init();
+        }
+
+        static constexpr checksum_state
+        checksum_update( checksum_state state, const view< const uint8_t* > data )
+        {
+                return Crc::update( state, data );
+        }
+
+        static constexpr checksum_type checksum_finalize( checksum_state state )
+        {
+                return Crc::finalize( state );
+        }
+};
+
 template < typename Def, typename Payload >
 using protocol_packet_base = protocol_tuple<
     Def::endianess,
@@ -49,6 +101,9 @@ struct protocol_packet : protocol_packet_base< Def, Payload >
         using checksum_type = typename Def::checksum_type;
         using checksum_decl = protocol_decl< checksum_type >;
 
+        static constexpr std::size_t checksum_size        = checksum_decl::max_size;
+        static constexpr bool        incremental_checksum = protocol_packet_incremental_def< Def >;
+
         static_assert( protocol_fixedly_sized< prefix_type > );
         static_assert( protocol_fixedly_sized< size_type > );
 
@@ -66,9 +121,53 @@ struct protocol_packet : protocol_packet_base< Def, Payload >
                         std::copy_n( buffer.begin() + prefix_size, size_size, tmp.begin() );
                         return serializer::deserialize( tmp ) + prefix_size + size_size;
                 }
+
+                static constexpr std::size_t checksum_size = checksum_decl::max_size;
+
+                static constexpr auto checksum_init() requires( incremental_checksum )
+                {
+                        return Def::checksum_init();
+                }
+
+                static constexpr auto checksum_update(
+                    auto                         state,
+                    const view< const uint8_t* > data ) requires( incremental_checksum )
+                {
+                        return Def::checksum_update( state, data );
+                }
+
+                static constexpr checksum_type
+                checksum_finalize( auto state ) requires( incremental_checksum )
+                {
+                        return Def::checksum_finalize( state );
+                }
+
+                // Compares the checksum with the checksum stored in the last bytes of message
+                static constexpr bool checksum_check(
+                    auto                         state,
+                    const view< const uint8_t* > present ) requires( incremental_checksum )
+                {
+                        std::array< uint8_t, checksum_size > tmp;
+                        std::copy_n( present.begin(), checksum_size, tmp.begin() );
+                        return protocol_serializer< checksum_type, endianess >::deserialize(
+                                   tmp ) == checksum_finalize( state );
+                }
         };
 
-        using sequencer = protocol_sequencer< sequencer_def >;
+        using sequencer      = protocol_sequencer< sequencer_def >;
+        using view_sequencer = protocol_view_sequencer< sequencer_def >;
+
+        // Sequencers that report their events to statistics policy `Stats`
+        template < protocol_stats_policy Stats >
+        using stats_sequencer = protocol_sequencer<
+            sequencer_def,
+            static_circular_buffer< uint8_t, base::message_type::max_size * 2 >,
+            Stats >;
+        template < protocol_stats_policy Stats >
+        using stats_view_sequencer = protocol_sequencer<
+            sequencer_def,
+            protocol_linear_buffer< base::message_type::max_size * 2 >,
+            Stats >;
 
         static constexpr checksum_type get_checksum( const view< const uint8_t* > mview )
         {
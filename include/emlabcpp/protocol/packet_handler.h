@@ -1,5 +1,6 @@
 #include "emlabcpp/protocol/handler.h"
 #include "emlabcpp/protocol/packet.h"
+#include "emlabcpp/protocol/stats.h"
 
 #pragma once
 
@@ -22,43 +23,142 @@ struct protocol_packet_handler
         static constexpr std::size_t size_size     = Packet::size_decl::max_size;
         static constexpr auto        endianess     = Packet::endianess;
 
+        using payload_def                        = protocol_def< payload_type, endianess >;
+        static constexpr std::size_t header_size = size_offset + size_size;
+        static constexpr std::size_t max_size    = message_type::max_size;
+
         static message_type serialize( const value_type& val )
         {
+                return message_type::make_with( [&]( std::span< uint8_t, max_size > buffer ) {
+                        return serialize_at( buffer, val );
+                } );
+        }
 
-                message_type msg = sub_handler::serialize(
-                    std::make_tuple( Packet::prefix, size_type{}, val, checksum_type{} ) );
-
-                auto size = static_cast< size_type >(
-                    msg.size() - Packet::prefix_decl::max_size - size_size );
-
-                protocol_serializer< size_type, endianess >::serialize_at(
-                    std::span< uint8_t, size_size >{ msg.begin() + size_offset, size_size }, size );
+        // Serializes the packet directly into the buffer and returns number of bytes used. Returns
+        // nothing in case the buffer is smaller than the maximal size of the packet.
+        static std::optional< std::size_t >
+        serialize_into( std::span< uint8_t > buffer, const value_type& val )
+        {
+                if ( buffer.size() < max_size ) {
+                        return {};
+                }
+                return serialize_at( buffer.template first< max_size >(), val );
+        }
 
-                checksum_type chcksm =
-                    Packet::get_checksum( view_n( msg.begin(), msg.size() - checksum_size ) );
+        static either< value_type, protocol_error_record >
+        extract( const view< const uint8_t* >& msg )
+        {
+                protocol_no_stats stats;
+                return extract( msg, stats );
+        }
 
-                protocol_serializer< checksum_type, endianess >::serialize_at(
-                    std::span< uint8_t, checksum_size >{ msg.end() - checksum_size, checksum_size },
-                    chcksm );
+        // Extracts the message and reports errors to `stats`
+        template < protocol_stats_policy Stats >
+        static either< value_type, protocol_error_record >
+        extract( const view< const uint8_t* >& msg, Stats& stats )
+        {
+                return sub_handler::extract( msg )
+                    .bind_left(
+                        [&]( std::tuple< prefix_type, size_type, value_type, checksum_type > pack )
+                            -> either< value_type, protocol_error_record > {
+                                checksum_type present_checksum    = std::get< 3 >( pack );
+                                checksum_type calculated_checksum = Packet::get_checksum(
+                                    view_n( msg.begin(), msg.size() - checksum_size ) );
+                                if ( present_checksum != calculated_checksum ) {
+                                        stats.on_checksum_failure();
+                                        return protocol_error_record{
+                                            CHECKSUM_ERR, msg.size() - checksum_size };
+                                }
+                                return std::get< 2 >( pack );
+                        } )
+                    .convert_right( [&]( protocol_error_record rec ) {
+                            if ( rec.mark != CHECKSUM_ERR ) {
+                                    stats.on_error( rec );
+                            }
+                            return rec;
+                    } );
+        }
 
-                return msg;
+        // Extracts message passed out by the view sequencer of packet with incremental checksum.
+        // The sequencer already checked the checksum, which protocol_verified_view guarantees, so
+        // it is not computed again.
+        static either< value_type, protocol_error_record >
+        extract_sequenced( const protocol_verified_view& msg ) requires(
+            Packet::incremental_checksum )
+        {
+                protocol_no_stats stats;
+                return extract_sequenced( msg, stats );
         }
 
+        template < protocol_stats_policy Stats >
         static either< value_type, protocol_error_record >
-        extract( const view< const uint8_t* >& msg )
+        extract_sequenced( const protocol_verified_view& msg, Stats& stats ) requires(
+            Packet::incremental_checksum )
         {
-                return sub_handler::extract( msg ).bind_left(
-                    [&]( std::tuple< prefix_type, size_type, value_type, checksum_type > pack )
-                        -> either< value_type, protocol_error_record > {
-                            checksum_type present_checksum    = std::get< 3 >( pack );
-                            checksum_type calculated_checksum = Packet::get_checksum(
-                                view_n( msg.begin(), msg.size() - checksum_size ) );
-                            if ( present_checksum != calculated_checksum ) {
-                                    return protocol_error_record{};
-                            }
+                using pack_type = std::tuple< prefix_type, size_type, value_type, checksum_type >;
+                return sub_handler::extract( msg )
+                    .convert_left( [&]( pack_type pack ) {
                             return std::get< 2 >( pack );
+                    } )
+                    .convert_right( [&]( protocol_error_record rec ) {
+                            stats.on_error( rec );
+                            return rec;
                     } );
         }
+
+private:
+        using checksum_def = typename Packet::sequencer_def;
+
+        // Checksum state after the prefix, which is the same for all packets. Computed at compile
+        // time for packets with incremental checksum.
+        static constexpr auto prefix_checksum = [] {
+                if constexpr ( Packet::incremental_checksum ) {
+                        // prefix is array of bytes, same as in the sequencer
+                        constexpr std::array< uint8_t, size_offset > tmp = Packet::prefix;
+                        return checksum_def::checksum_update(
+                            checksum_def::checksum_init(), view_n( tmp.data(), size_offset ) );
+                } else {
+                        return 0;
+                }
+        }();
+
+        // Writes prefix, payload right after the slot for size and the size once the payload size
+        // is known. The checksum covers the size, which precedes the payload, so it is computed in
+        // second pass over the bytes that were just written: packets with incremental checksum fold
+        // the size and the payload into the state of the prefix, others compute the checksum over
+        // the whole packet.
+        static std::size_t
+        serialize_at( std::span< uint8_t, max_size > buffer, const value_type& val )
+        {
+                protocol_def< prefix_type, endianess >::serialize_at(
+                    buffer.template first< size_offset >(), Packet::prefix );
+
+                bounded payload_size = payload_def::serialize_at(
+                    buffer.template subspan< header_size, payload_def::max_size >(), val );
+
+                protocol_serializer< size_type, endianess >::serialize_at(
+                    buffer.template subspan< size_offset, size_size >(),
+                    static_cast< size_type >( *payload_size + checksum_size ) );
+
+                std::size_t   checksum_offset = header_size + *payload_size;
+                checksum_type chcksm;
+                if constexpr ( Packet::incremental_checksum ) {
+                        auto state = checksum_def::checksum_update(
+                            prefix_checksum, view_n( buffer.data() + size_offset, size_size ) );
+                        state = checksum_def::checksum_update(
+                            state, view_n( buffer.data() + header_size, *payload_size ) );
+                        chcksm = checksum_def::checksum_finalize( state );
+                } else {
+                        chcksm = Packet::get_checksum( view_n( buffer.data(), checksum_offset ) );
+                }
+
+                protocol_serializer< checksum_type, endianess >::serialize_at(
+                    std::span< uint8_t, checksum_size >{
+                        buffer.data() + checksum_offset, checksum_size },
+                    chcksm );
+
+                return checksum_offset + checksum_size;
+        }
 };
 
 }  // namespace emlabcpp
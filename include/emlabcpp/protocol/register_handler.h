@@ -6,10 +6,25 @@
 namespace emlabcpp
 {
 
+// Map that keeps track of modified registers, such as protocol_tracked_register_map
+template < typename Map >
+concept protocol_register_map_tracking = requires( Map m )
+{
+        m.consume_dirty( []( const auto& ) {} );
+};
+
 // Handler for serialization and extraction of datatypes used by the register_map. This provides
 // interface for handling conversion of bytes to types used in the map. `serialize` and `extract`
 // works directly with the types used by the map, based on compile time key. `select` and `insert`
 // works with the map itself based on runtime information.
+//
+// Modified registers of tracked map can be serialized into one delta message with
+// `serialize_delta`, which is sequence of records made of the key and the value of register.
+// `insert_delta` applies the records to the map on the other side.
+//
+// Devices that support block transfers can read or write range of registers at once, the block
+// made by `select_range` and parsed by `insert_range` contains values of the registers in the order
+// of the map, without the keys.
 template < typename Map >
 struct protocol_register_handler
 {
@@ -20,18 +35,59 @@ struct protocol_register_handler
 
         using message_type = typename map_type::message_type;
 
+        using key_def                         = protocol_def< key_type, Map::endianess >;
+        static constexpr std::size_t key_size = key_def::max_size;
+
+        // Size of delta message with all registers
+        static constexpr std::size_t delta_max_size =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    using registers_tuple = typename map_type::registers_tuple;
+                    return (
+                        std::size_t{ 0 } + ... +
+                        ( key_size + std::tuple_element_t< Is, registers_tuple >::size ) );
+            }( std::make_index_sequence< map_type::registers_count >{} );
+
+        using delta_message_type = protocol_message< delta_max_size >;
+
+        using register_index = typename map_type::register_index;
+
+        // Offsets of registers in block of all registers of the map, the last item is the size of
+        // the whole block
+        static constexpr auto range_offsets =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    using registers_tuple = typename map_type::registers_tuple;
+                    std::array< std::size_t, sizeof...( Is ) > sizes = {
+                        std::tuple_element_t< Is, registers_tuple >::size... };
+                    std::array< std::size_t, sizeof...( Is ) + 1 > res{};
+                    for ( std::size_t i = 0; i < sizes.size(); i++ ) {
+                            res[i + 1] = res[i] + sizes[i];
+                    }
+                    return res;
+            }( std::make_index_sequence< map_type::registers_count >{} );
+
+        static constexpr std::size_t range_max_size = range_offsets.back();
+        using range_message_type                    = protocol_message< range_max_size >;
+
         template < key_type Key >
         static message_type serialize( typename map_type::reg_value_type< Key > val )
         {
-                using def = protocol_def< typename map_type::reg_def_type< Key >, Map::endianess >;
-
-                std::array< uint8_t, max_size > buffer;
-                static_assert( def::max_size <= max_size );
-                bounded used = def::serialize_at(
-                    std::span< uint8_t, def::max_size >( buffer.begin(), def::max_size ), val );
-                EMLABCPP_ASSERT( *used <= max_size );
+                return message_type::make_with( [&]( std::span< uint8_t, max_size > buffer ) {
+                        return serialize_at< Key >( buffer, val );
+                } );
+        }
 
-                return *message_type::make( view_n( buffer.begin(), *used ) );
+        // Serializes the value of register directly into the buffer and returns number of bytes
+        // used. The buffer has to have at least the maximal size of the register, as with
+        // protocol_handler::serialize_into, nothing is returned otherwise.
+        template < key_type Key >
+        static std::optional< std::size_t >
+        serialize_into( std::span< uint8_t > buffer, typename map_type::reg_value_type< Key > val )
+        {
+                using def = protocol_def< typename map_type::reg_def_type< Key >, Map::endianess >;
+                if ( buffer.size() < def::max_size ) {
+                        return {};
+                }
+                return serialize_at< Key >( buffer, val );
         }
 
         static message_type select( const map_type& m, key_type key )
@@ -41,31 +97,215 @@ struct protocol_register_handler
                 } );
         }
 
+        // Serializes register with `key` directly into the buffer, same as serialize_into.
+        static std::optional< std::size_t >
+        select_into( const map_type& m, key_type key, std::span< uint8_t > buffer )
+        {
+                return m.with_register( key, [&]< typename reg_type >( const reg_type& reg ) {
+                        return serialize_into< reg_type::key >( buffer, reg.value );
+                } );
+        }
+
         template < key_type Key >
         static either< typename map_type::reg_value_type< Key >, protocol_error_record >
         extract( const view< const uint8_t* >& msg )
         {
-                using def = protocol_def< typename map_type::reg_def_type< Key >, Map::endianess >;
+                std::size_t used = 0;
+                return extract_used< Key >( msg, used );
+        }
 
-                auto opt_view = bounded_view< const uint8_t*, typename def::size_type >::make(
-                    view_n( msg.begin(), min( def::max_size, msg.size() ) ) );
-                if ( !opt_view ) {
-                        return protocol_error_record{ SIZE_ERR, 0 };
-                }
-                auto [used, res] = def::deserialize( *opt_view );
-                if ( std::holds_alternative< const protocol_mark* >( res ) ) {
-                        return protocol_error_record{ *std::get< 1 >( res ), used };
+        // Serializes all modified registers of the map and clears their dirty bits
+        static delta_message_type serialize_delta( map_type& m ) requires(
+            protocol_register_map_tracking< map_type > )
+        {
+                return delta_message_type::make_with(
+                    [&]( std::span< uint8_t, delta_max_size > buffer ) {
+                            return serialize_delta_into( m, buffer );
+                    } );
+        }
+
+        // Serializes records of modified registers into the buffer while they fit and returns
+        // number of bytes used. Registers that did not fit stay modified for the next message.
+        static std::size_t
+        serialize_delta_into( map_type& m, std::span< uint8_t > buffer ) requires(
+            protocol_register_map_tracking< map_type > )
+        {
+                std::size_t used = 0;
+                m.consume_dirty( [&]< typename reg_type >( const reg_type& reg ) {
+                        using def = protocol_def< typename reg_type::def_type, Map::endianess >;
+                        if ( buffer.size() - used < key_size + def::max_size ) {
+                                return false;
+                        }
+                        key_def::serialize_at(
+                            buffer.subspan( used ).template first< key_size >(), reg_type::key );
+                        used += key_size;
+                        used += serialize_at< reg_type::key >( buffer.subspan( used ), reg.value );
+                        return true;
+                } );
+                return used;
+        }
+
+        // Inserts all records of delta message into the map. Stops at the first record that can't
+        // be inserted and returns the error, records before it are inserted.
+        static std::optional< protocol_error_record >
+        insert_delta( map_type& m, const view< const uint8_t* >& msg )
+        {
+                std::size_t offset = 0;
+                while ( offset < msg.size() ) {
+                        auto opt_key_view = bounded_view<
+                            const uint8_t*,
+                            typename key_def::size_type >::make( view_n(
+                            msg.begin() + offset, min( key_size, msg.size() - offset ) ) );
+                        if ( !opt_key_view ) {
+                                return protocol_error_record{ LOWSIZE_ERR, offset };
+                        }
+                        auto [kused, kres] = key_def::deserialize( *opt_key_view );
+                        if ( std::holds_alternative< const protocol_mark* >( kres ) ) {
+                                return protocol_error_record{ *std::get< 1 >( kres ), offset };
+                        }
+                        key_type key = std::get< 0 >( kres );
+                        if ( !m.contains( key ) ) {
+                                return protocol_error_record{ UNDEFKEY_ERR, offset };
+                        }
+                        offset += key_size;
+
+                        std::size_t used = 0;
+                        auto        res  = insert_used(
+                            m, key, view_n( msg.begin() + offset, msg.size() - offset ), used );
+                        if ( res ) {
+                                res->offset += offset;
+                                return res;
+                        }
+                        offset += used;
                 }
-                return std::get< 0 >( res );
+                return {};
         }
 
         static std::optional< protocol_error_record >
         insert( map_type& m, key_type key, const view< const uint8_t* >& buff )
+        {
+                std::size_t used = 0;
+                return insert_used( m, key, buff, used );
+        }
+
+        // Serializes values of registers from `first` up to and including `last`, in the order of
+        // the registers in the map, as one contiguous block. Returns nothing in case any of the
+        // keys is not in the map or `last` precedes `first`.
+        static std::optional< range_message_type >
+        select_range( const map_type& m, key_type first, key_type last )
+        {
+                std::optional< std::size_t > opt_used;
+                range_message_type           msg = range_message_type::make_with(
+                    [&]( std::span< uint8_t, range_max_size > buffer ) {
+                            opt_used = select_range_into( m, first, last, buffer );
+                            return opt_used.value_or( 0 );
+                    } );
+                if ( !opt_used ) {
+                        return {};
+                }
+                return msg;
+        }
+
+        // Serializes the block of registers directly into the buffer, same as select_range.
+        // Returns nothing also in case the buffer is smaller than the block.
+        static std::optional< std::size_t > select_range_into(
+            const map_type&      m,
+            key_type             first,
+            key_type             last,
+            std::span< uint8_t > buffer )
+        {
+                auto opt_first = map_type::find_index( first );
+                auto opt_last  = map_type::find_index( last );
+                if ( !opt_first || !opt_last || **opt_last < **opt_first ) {
+                        return {};
+                }
+                std::size_t from = **opt_first;
+                std::size_t to   = **opt_last + 1;
+                if ( buffer.size() < range_offsets[to] - range_offsets[from] ) {
+                        return {};
+                }
+
+                std::size_t used = 0;
+                for ( std::size_t i = from; i < to; i++ ) {
+                        auto index = *register_index::make( i );
+                        m.with_register_at( index, [&]< typename reg_type >( const reg_type& reg ) {
+                                used += serialize_at< reg_type::key >(
+                                    buffer.subspan( used ), reg.value );
+                        } );
+                }
+                return used;
+        }
+
+        // Inserts block of register values produced by select_range, starting with register
+        // `first`. The number of registers is given by the size of the block. Stops at the first
+        // value that can't be inserted and returns the error, values before it are inserted.
+        static std::optional< protocol_error_record >
+        insert_range( map_type& m, key_type first, const view< const uint8_t* >& buff )
+        {
+                auto opt_first = map_type::find_index( first );
+                if ( !opt_first ) {
+                        return protocol_error_record{ UNDEFKEY_ERR, 0 };
+                }
+
+                std::size_t offset = 0;
+                for ( std::size_t i = **opt_first; offset < buff.size(); i++ ) {
+                        if ( i == map_type::registers_count ) {
+                                return protocol_error_record{ BIGSIZE_ERR, offset };
+                        }
+                        std::size_t used = 0;
+                        auto        res  = insert_at_table[i](
+                            m, view_n( buff.begin() + offset, buff.size() - offset ), used );
+                        if ( res ) {
+                                res->offset += offset;
+                                return res;
+                        }
+                        offset += used;
+                }
+                return {};
+        }
+
+private:
+        using insert_at_fn = std::optional< protocol_error_record > ( * )(
+            map_type&, const view< const uint8_t* >&, std::size_t& );
+
+        // Inserts value of register at index `I` from the start of the message, the register is
+        // known at compile time so no lookup by key is necessary
+        template < std::size_t I >
+        static std::optional< protocol_error_record >
+        insert_at( map_type& m, const view< const uint8_t* >& buff, std::size_t& used )
+        {
+                static constexpr key_type key = map_type::register_key( bounded_constant< I > );
+
+                std::optional< protocol_error_record > res;
+                extract_used< key >( buff, used )
+                    .match(
+                        [&]( auto val ) {
+                                m.template set_val< key >( val );
+                        },
+                        [&]( protocol_error_record err ) {
+                                res = err;
+                        } );
+                return res;
+        }
+
+        static constexpr auto insert_at_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< insert_at_fn, map_type::registers_count >{
+                        &insert_at< Is >... };
+            }( std::make_index_sequence< map_type::registers_count >{} );
+
+        // Inserts value of register with `key` from the start of the message and stores number of
+        // bytes used by the value into `used`
+        static std::optional< protocol_error_record > insert_used(
+            map_type&                     m,
+            key_type                      key,
+            const view< const uint8_t* >& buff,
+            std::size_t&                  used )
         {
                 std::optional< protocol_error_record > res;
                 m.setup_register( key, [&]< typename reg_type >() {
-                        return extract< reg_type::key >( buff )
-                            .convert_right( [&]( auto err ) {
+                        return extract_used< reg_type::key >( buff, used )
+                            .convert_right( [&]( protocol_error_record err ) {
                                     res = err;
                                     return m.template get_val< reg_type::key >();
                             } )
@@ -73,6 +313,39 @@ struct protocol_register_handler
                 } );
                 return res;
         }
+
+        // Extracts the value of register from the start of the message and stores number of bytes
+        // used by the value into `used`.
+        template < key_type Key >
+        static either< typename map_type::reg_value_type< Key >, protocol_error_record >
+        extract_used( const view< const uint8_t* >& msg, std::size_t& used )
+        {
+                using def = protocol_def< typename map_type::reg_def_type< Key >, Map::endianess >;
+
+                auto opt_view = bounded_view< const uint8_t*, typename def::size_type >::make(
+                    view_n( msg.begin(), min( def::max_size, msg.size() ) ) );
+                if ( !opt_view ) {
+                        return protocol_error_record{ SIZE_ERR, 0 };
+                }
+                auto [dused, res] = def::deserialize( *opt_view );
+                if ( std::holds_alternative< const protocol_mark* >( res ) ) {
+                        return protocol_error_record{ *std::get< 1 >( res ), dused };
+                }
+                used = dused;
+                return std::get< 0 >( res );
+        }
+
+        // Buffer has to be at least as big as the serialized register, this is checked by callers.
+        template < key_type Key >
+        static std::size_t serialize_at( std::span< uint8_t > buffer, const auto& val )
+        {
+                using def = protocol_def< typename map_type::reg_def_type< Key >, Map::endianess >;
+                static_assert( def::max_size <= max_size );
+
+                bounded used = def::serialize_at( buffer.template first< def::max_size >(), val );
+                EMLABCPP_ASSERT( *used <= max_size );
+                return *used;
+        }
 };
 
 }  // namespace emlabcpp
@@ -0,0 +1,204 @@
+#include "emlabcpp/algorithm.h"
+#include "emlabcpp/crc.h"
+#include "emlabcpp/either.h"
+#include "emlabcpp/protocol/register_handler.h"
+#include "emlabcpp/protocol/schema.h"
+#include "emlabcpp/protocol/tuple.h"
+
+#include <array>
+#include <optional>
+#include <span>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Binary image of the whole register map, used to store the map persistently. The image is made of
+// header and of values of all registers, in the format of `select_range` block. Everything is in
+// the endianess of the map:
+//  - magic `protocol_register_image_magic`, 32 bit
+//  - version of the format, 8 bit
+//  - hash of the schema of the map, 32 bit
+//  - number of registers, 16 bit
+//  - keys of the registers in the order of the map
+//  - size of the block of values, 32 bit
+//  - the block of values
+//
+// The schema hash is CRC-32 over the endianess, the keys, the sizes and the `protocol_schema` of
+// types of the registers, computed at compile time. Image made for map with different schema is
+// refused, the header of such image is reported as BADVAL_ERR with offset of the item that did not
+// match. The values are parsed in one pass, directly from the memory the image is in.
+static constexpr uint32_t protocol_register_image_magic = 0x454d5249;
+
+template < typename Map >
+struct protocol_register_image
+{
+        using map_type = Map;
+        using key_type = typename map_type::key_type;
+        using handler  = protocol_register_handler< map_type >;
+
+        static constexpr std::size_t registers_count = map_type::registers_count;
+        static constexpr uint8_t     version         = 2;
+
+        static constexpr uint32_t schema_hash = [] {
+                // endianess, and for each register 64 bit key with 16 bit min and max size and 32
+                // bit hash of its schema
+                std::array< uint8_t, 1 + registers_count * 16 > desc{};
+                desc[0] = static_cast< uint8_t >( map_type::endianess );
+                auto put = [&]( std::size_t offset, uint64_t val, std::size_t n ) {
+                        for ( std::size_t i = 0; i < n; i++ ) {
+                                desc[offset + i] = static_cast< uint8_t >( val >> ( 8 * i ) );
+                        }
+                };
+                for_each_index< registers_count >( [&]< std::size_t i >() {
+                        using reg_type =
+                            std::tuple_element_t< i, typename map_type::registers_tuple >;
+                        std::size_t offset = 1 + i * 16;
+                        put( offset, static_cast< uint64_t >( reg_type::key ), 8 );
+                        put( offset + 8, reg_type::decl::min_size, 2 );
+                        put( offset + 10, reg_type::decl::max_size, 2 );
+                        put( offset + 12, protocol_schema< typename reg_type::def_type >::hash, 4 );
+                } );
+                return crc32::compute( view_n( desc.data(), desc.size() ) );
+        }();
+
+        using keys_type   = std::array< key_type, registers_count >;
+        using header_type = protocol_tuple<
+            map_type::endianess,
+            tag< protocol_register_image_magic >,
+            tag< version >,
+            tag< schema_hash >,
+            tag< static_cast< uint16_t >( registers_count ) >,
+            keys_type,
+            uint32_t >;
+        using header_def = protocol_def< header_type, map_type::endianess >;
+
+        static constexpr std::size_t header_size = header_def::max_size;
+        static constexpr std::size_t max_size    = header_size + handler::range_max_size;
+
+        using message_type = protocol_message< max_size >;
+
+        static message_type serialize( const map_type& m )
+        {
+                return message_type::make_with( [&]( std::span< uint8_t, max_size > buffer ) {
+                        return serialize_at( buffer, m );
+                } );
+        }
+
+        // Serializes the image directly into the buffer and returns number of bytes used. Returns
+        // nothing in case the buffer is smaller than the maximal size of the image.
+        static std::optional< std::size_t >
+        serialize_into( std::span< uint8_t > buffer, const map_type& m )
+        {
+                if ( buffer.size() < max_size ) {
+                        return {};
+                }
+                return serialize_at( buffer.template first< max_size >(), m );
+        }
+
+        // Loads image from the start of `data` into the map and returns number of bytes used by the
+        // image, so images stored back to back can be loaded one after another. The image is
+        // decoded into temporary map first, in case of error the map is left unchanged.
+        static either< std::size_t, protocol_error_record >
+        insert( map_type& m, const view< const uint8_t* >& data )
+        {
+                map_type tmp;
+                return load( tmp, data ).convert_left( [&]( std::size_t used ) {
+                        m = tmp;
+                        return used;
+                } );
+        }
+
+        // Extracts map from image at the start of `data`
+        static either< map_type, protocol_error_record >
+        extract( const view< const uint8_t* >& data )
+        {
+                map_type m;
+                return load( m, data ).convert_left( [&]( std::size_t ) {
+                        return m;
+                } );
+        }
+
+private:
+        static constexpr keys_type register_keys = [] {
+                keys_type res{};
+                for_each_index< registers_count >( [&]< std::size_t i >() {
+                        res[i] = map_type::register_key( bounded_constant< i > );
+                } );
+                return res;
+        }();
+        static constexpr key_type first_key = register_keys.front();
+        static constexpr key_type last_key  = register_keys.back();
+
+        static constexpr std::size_t values_size_offset =
+            header_size - protocol_decl< uint32_t >::max_size;
+        static constexpr std::size_t keys_offset =
+            values_size_offset - protocol_decl< keys_type >::max_size;
+
+        // Values of registers have to take at least this many bytes
+        static constexpr std::size_t values_min_size =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    using registers_tuple = typename map_type::registers_tuple;
+                    return (
+                        std::size_t{ 0 } + ... +
+                        std::tuple_element_t< Is, registers_tuple >::decl::min_size );
+            }( std::make_index_sequence< registers_count >{} );
+
+        // Loads the image into the map, registers before the failed one may be already loaded in
+        // case of error
+        static either< std::size_t, protocol_error_record >
+        load( map_type& m, const view< const uint8_t* >& data )
+        {
+                using bview_type = bounded_view< const uint8_t*, typename header_def::size_type >;
+
+                if ( data.size() < header_size ) {
+                        return protocol_error_record{ LOWSIZE_ERR, data.size() };
+                }
+                auto [hused, hres] = header_def::deserialize(
+                    bview_type::template make_n< header_size >( data.begin() ) );
+                if ( std::holds_alternative< const protocol_mark* >( hres ) ) {
+                        return protocol_error_record{ *std::get< 1 >( hres ), hused };
+                }
+                const auto& header = std::get< 0 >( hres );
+
+                const keys_type& keys = std::get< 4 >( header );
+                for ( std::size_t i = 0; i < registers_count; i++ ) {
+                        if ( keys[i] != register_keys[i] ) {
+                                return protocol_error_record{
+                                    BADVAL_ERR, keys_offset + i * handler::key_size };
+                        }
+                }
+
+                std::size_t values_size = std::get< 5 >( header );
+                if ( values_size < values_min_size || values_size > handler::range_max_size ) {
+                        return protocol_error_record{ BADVAL_ERR, values_size_offset };
+                }
+                if ( data.size() - header_size < values_size ) {
+                        return protocol_error_record{ LOWSIZE_ERR, data.size() };
+                }
+
+                auto err = handler::insert_range(
+                    m, first_key, view_n( data.begin() + header_size, values_size ) );
+                if ( err ) {
+                        err->offset += header_size;
+                        return *err;
+                }
+                return header_size + values_size;
+        }
+
+        static std::size_t serialize_at( std::span< uint8_t, max_size > buffer, const map_type& m )
+        {
+                std::size_t values_size = *handler::select_range_into(
+                    m, first_key, last_key, buffer.subspan( header_size ) );
+
+                typename header_type::value_type header{};
+                std::get< 4 >( header ) = register_keys;
+                std::get< 5 >( header ) = static_cast< uint32_t >( values_size );
+                header_def::serialize_at( buffer.template first< header_size >(), header );
+
+                return header_size + values_size;
+        }
+};
+
+}  // namespace emlabcpp
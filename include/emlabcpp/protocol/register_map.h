@@ -1,6 +1,16 @@
 #include "emlabcpp/algorithm.h"
 #include "emlabcpp/protocol/base.h"
 #include "emlabcpp/protocol/decl.h"
+#include "emlabcpp/protocol/key_index.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
 #pragma once
 
@@ -52,19 +62,34 @@ public:
 private:
         registers_tuple registers_;
 
+        using key_index_type = protocol_key_index< Regs::key... >;
+
         static constexpr std::size_t get_reg_index( key_type k )
         {
-                std::size_t res = std::tuple_size_v< registers_tuple >;
-                until_index< sizeof...( Regs ) >( [&]< std::size_t i >() {
-                        if ( std::tuple_element_t< i, registers_tuple >::key == k ) {
-                                res = i;
-                                return true;
-                        }
-                        return false;
-                } );
-                return res;
+                return key_index_type::find( k );
+        }
+
+        template < std::size_t I, typename UnaryFunction >
+        static constexpr void visit_register( const registers_tuple& regs, UnaryFunction& f )
+        {
+                f( std::get< I >( regs ) );
         }
 
+        template < typename UnaryFunction >
+        using visit_fn = void ( * )( const registers_tuple&, UnaryFunction& );
+
+        // Table of functions that call `UnaryFunction` with register at the index
+        template < typename UnaryFunction >
+        static constexpr auto visit_table =
+            []< std::size_t... Is >( std::index_sequence< Is... > ) {
+                    return std::array< visit_fn< UnaryFunction >, registers_count >{
+                        &visit_register< Is, UnaryFunction >... };
+            }( std::index_sequence_for< Regs... >{} );
+
+        static constexpr std::array< std::size_t, registers_count > register_sizes = {
+            Regs::size... };
+        static constexpr std::array< key_type, registers_count > register_keys = { Regs::key... };
+
 public:
         template < key_type Key >
         static constexpr std::size_t key_index = get_reg_index( Key );
@@ -96,6 +121,12 @@ public:
                 return get_reg_index( key ) != std::tuple_size_v< registers_tuple >;
         }
 
+        // Index of register with `key`, or nothing in case the map does not contain the key
+        static constexpr std::optional< register_index > find_index( key_type key )
+        {
+                return register_index::make( get_reg_index( key ) );
+        }
+
         template < key_type Key >
         reg_value_type< Key > get_val() const
         {
@@ -114,16 +145,12 @@ public:
 
         static constexpr std::size_t register_size( register_index i )
         {
-                return select_index( i, [&]< std::size_t j >() {
-                        return std::tuple_element_t< j, registers_tuple >::size;
-                } );
+                return register_sizes[*i];
         }
 
         static constexpr key_type register_key( register_index i )
         {
-                return select_index( i, [&]< std::size_t j >() {
-                        return std::tuple_element_t< j, registers_tuple >::key;
-                } );
+                return register_keys[*i];
         }
 
         template < typename UnaryFunction >
@@ -157,15 +184,229 @@ public:
                 registers_tuple > ) constexpr void with_register( key_type key, UnaryFunction&& f )
             const
         {
-                until_index< registers_count >( [&]< std::size_t j >() {
-                        using reg_type = std::tuple_element_t< j, registers_tuple >;
-                        if ( reg_type::key != key ) {
-                                return false;
+                std::optional< register_index > opt_i = find_index( key );
+                if ( opt_i ) {
+                        with_register_at( *opt_i, f );
+                }
+        }
+
+        // Calls `f` with register at index `i`
+        template < typename UnaryFunction >
+        constexpr void with_register_at( register_index i, UnaryFunction&& f ) const
+        {
+                visit_table< std::remove_reference_t< UnaryFunction > >[*i]( registers_, f );
+        }
+};
+
+// Register map that keeps track of registers modified since their last synchronization. Each
+// register has dirty bit that is set once its value is changed by `set_val` or `setup_register`,
+// and thus by protocol_register_handler::insert as well. `consume_dirty` iterates only over
+// the modified registers and clears their bits.
+//
+// The underlying map is held privately and only read-only access to it is provided, so every
+// write goes through the tracking setters. The map provides the same interface as `Map`, so it can
+// be used with protocol_register_handler and other utilities for register maps.
+template < typename Map >
+class protocol_tracked_register_map
+{
+public:
+        using map_type                                     = Map;
+        static constexpr protocol_endianess_enum endianess = Map::endianess;
+        using registers_tuple                              = typename Map::registers_tuple;
+        using key_type                                     = typename Map::key_type;
+        using register_index                               = typename Map::register_index;
+        using message_type                                 = typename Map::message_type;
+
+        static constexpr std::size_t registers_count = Map::registers_count;
+        static constexpr std::size_t max_value_size  = Map::max_value_size;
+
+        template < key_type Key >
+        static constexpr std::size_t key_index = Map::template key_index< Key >;
+
+        template < key_type Key >
+        static constexpr bool contains_key = Map::template contains_key< Key >;
+
+        template < key_type Key >
+        using reg_type = typename Map::template reg_type< Key >;
+
+        template < key_type Key >
+        using reg_value_type = typename Map::template reg_value_type< Key >;
+
+        template < key_type Key >
+        using decl = typename Map::template decl< Key >;
+
+        template < key_type Key >
+        using reg_def_type = typename Map::template reg_def_type< Key >;
+
+        protocol_tracked_register_map() = default;
+
+        // Tracks changes of map `m`, none of its registers is considered modified
+        explicit protocol_tracked_register_map( const Map& m )
+          : map_( m )
+        {
+        }
+
+        [[nodiscard]] const Map& map() const
+        {
+                return map_;
+        }
+
+        constexpr bool contains( key_type key ) const
+        {
+                return map_.contains( key );
+        }
+
+        static constexpr std::optional< register_index > find_index( key_type key )
+        {
+                return Map::find_index( key );
+        }
+
+        static constexpr std::size_t register_size( register_index i )
+        {
+                return Map::register_size( i );
+        }
+
+        static constexpr key_type register_key( register_index i )
+        {
+                return Map::register_key( i );
+        }
+
+        template < key_type Key >
+        reg_value_type< Key > get_val() const
+        {
+                return map_.template get_val< Key >();
+        }
+
+        template < key_type Key >
+        void set_val( reg_value_type< Key > val )
+        {
+                update( key_index< Key >, map_.template get_val< Key >(), val );
+                map_.template set_val< Key >( val );
+        }
+
+        template < typename UnaryFunction >
+        constexpr void setup_register( key_type key, UnaryFunction&& f )
+        {
+                map_.setup_register( key, [&]< typename reg_type >() {
+                        auto val = f.template operator()< reg_type >();
+                        update(
+                            key_index< reg_type::key >,
+                            map_.template get_val< reg_type::key >(),
+                            val );
+                        return val;
+                } );
+        }
+
+        template < typename UnaryFunction >
+        constexpr decltype( auto ) with_register( key_type key, UnaryFunction&& f ) const
+        {
+                return map_.with_register( key, std::forward< UnaryFunction >( f ) );
+        }
+
+        template < typename UnaryFunction >
+        constexpr void with_register_at( register_index i, UnaryFunction&& f ) const
+        {
+                map_.with_register_at( i, std::forward< UnaryFunction >( f ) );
+        }
+
+        [[nodiscard]] bool is_dirty( key_type key ) const
+        {
+                std::optional< register_index > opt_i = find_index( key );
+                return opt_i && ( dirty_[**opt_i / word_bits] & bit_of( **opt_i ) ) != 0;
+        }
+
+        [[nodiscard]] std::size_t dirty_count() const
+        {
+                std::size_t res = 0;
+                for ( word_type w : dirty_ ) {
+                        res += static_cast< std::size_t >( std::popcount( w ) );
+                }
+                return res;
+        }
+
+        void mark_dirty( key_type key )
+        {
+                std::optional< register_index > opt_i = find_index( key );
+                if ( opt_i ) {
+                        mark( **opt_i );
+                }
+        }
+
+        // Marks all registers as modified, for example to synchronize whole map at the start
+        void mark_all_dirty()
+        {
+                for ( std::size_t i = 0; i < registers_count; i++ ) {
+                        mark( i );
+                }
+        }
+
+        void clear_dirty()
+        {
+                dirty_.fill( 0 );
+        }
+
+        // Calls `f` with each modified register, in order of the registers in the map, and clears
+        // its dirty bit. In case `f` returns false, the iteration stops and the register stays
+        // modified.
+        template < typename UnaryFunction >
+        void consume_dirty( UnaryFunction&& f )
+        {
+                for ( std::size_t w = 0; w < dirty_.size(); w++ ) {
+                        while ( dirty_[w] != 0 ) {
+                                auto        bit = std::countr_zero( dirty_[w] );
+                                std::size_t i   = w * word_bits + static_cast< std::size_t >( bit );
+                                if ( !visit( i, f ) ) {
+                                        return;
+                                }
+                                dirty_[w] &= static_cast< word_type >( dirty_[w] - 1 );
+                        }
+                }
+        }
+
+private:
+        using word_type                        = uint32_t;
+        static constexpr std::size_t word_bits = 32;
+
+        static constexpr word_type bit_of( std::size_t i )
+        {
+                return word_type{ 1 } << ( i % word_bits );
+        }
+
+        void mark( std::size_t i )
+        {
+                dirty_[i / word_bits] |= bit_of( i );
+        }
+
+        // Calls `f` with register at index `i`, returns false in case `f` asks to stop
+        template < typename UnaryFunction >
+        bool visit( std::size_t i, UnaryFunction& f ) const
+        {
+                bool res = true;
+                map_.with_register_at( *register_index::make( i ), [&]( const auto& reg ) {
+                        if constexpr ( std::is_void_v< decltype( f( reg ) ) > ) {
+                                f( reg );
+                        } else {
+                                res = f( reg );
                         }
-                        f( std::get< j >( registers_ ) );
-                        return true;
                 } );
+                return res;
         }
+
+        // Marks the register as modified in case the value changes, values that can't be compared
+        // are always considered as changed
+        template < typename T >
+        void update( std::size_t i, const T& old_val, const T& new_val )
+        {
+                if constexpr ( std::equality_comparable< T > ) {
+                        if ( old_val == new_val ) {
+                                return;
+                        }
+                }
+                mark( i );
+        }
+
+        Map                                                                      map_;
+        std::array< word_type, ( registers_count + word_bits - 1 ) / word_bits > dirty_{};
 };
 
 template < typename Map, typename UnaryFunction >
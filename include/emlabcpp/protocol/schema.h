@@ -0,0 +1,221 @@
+#include "emlabcpp/crc.h"
+#include "emlabcpp/protocol/decl.h"
+
+#include <array>
+#include <bit>
+#include <bitset>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+namespace detail
+{
+        enum protocol_schema_kind : uint8_t
+        {
+                PROTOCOL_SCHEMA_OPAQUE,
+                PROTOCOL_SCHEMA_UNSIGNED,
+                PROTOCOL_SCHEMA_SIGNED,
+                PROTOCOL_SCHEMA_ENUM,
+                PROTOCOL_SCHEMA_FLOATING,
+                PROTOCOL_SCHEMA_ARRAY,
+                PROTOCOL_SCHEMA_TUPLE,
+                PROTOCOL_SCHEMA_VARIANT,
+                PROTOCOL_SCHEMA_BITSET,
+                PROTOCOL_SCHEMA_BYTES,
+                PROTOCOL_SCHEMA_VECTOR,
+                PROTOCOL_SCHEMA_OFFSET,
+                PROTOCOL_SCHEMA_QUANTITY,
+                PROTOCOL_SCHEMA_BOUNDED,
+                PROTOCOL_SCHEMA_SIZED_BUFFER,
+                PROTOCOL_SCHEMA_TAG,
+                PROTOCOL_SCHEMA_GROUP,
+                PROTOCOL_SCHEMA_ENDIANESS
+        };
+
+        // Parameters of definitions are described by their bits, values of other types than
+        // numbers and enums are not described
+        template < typename T >
+        constexpr uint64_t protocol_schema_value( T val )
+        {
+                if constexpr ( std::is_enum_v< T > ) {
+                        return static_cast< uint64_t >(
+                            static_cast< std::underlying_type_t< T > >( val ) );
+                } else if constexpr ( std::floating_point< T > ) {
+                        return std::bit_cast< uint64_t >( static_cast< double >( val ) );
+                } else if constexpr ( std::is_integral_v< T > ) {
+                        return static_cast< uint64_t >( val );
+                } else {
+                        return 0;
+                }
+        }
+
+        // CRC-32 over the kind and 64 bit little endian values
+        template < typename... Ts >
+        constexpr uint32_t protocol_schema_combine( protocol_schema_kind kind, Ts... vals )
+        {
+                std::array< uint64_t, sizeof...( Ts ) > items{ protocol_schema_value( vals )... };
+                std::array< uint8_t, 1 + 8 * sizeof...( Ts ) > desc{};
+                desc[0] = kind;
+                for ( std::size_t i = 0; i < items.size(); i++ ) {
+                        for ( std::size_t j = 0; j < 8; j++ ) {
+                                desc[1 + i * 8 + j] =
+                                    static_cast< uint8_t >( items[i] >> ( 8 * j ) );
+                        }
+                }
+                return crc32::compute( view_n( desc.data(), desc.size() ) );
+        }
+}  // namespace detail
+
+// Hash describing how the values of definition `D` are interpreted: kind of numbers, their size,
+// parameters of the definition and the shape of nested definitions. Definitions that are not
+// described explicitly are described only by their sizes.
+template < typename D >
+struct protocol_schema
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_OPAQUE,
+            protocol_decl< D >::min_size,
+            protocol_decl< D >::max_size );
+};
+
+template < protocol_base_type D >
+struct protocol_schema< D >
+{
+        static constexpr uint32_t hash = [] {
+                if constexpr ( std::is_enum_v< D > ) {
+                        return detail::protocol_schema_combine(
+                            detail::PROTOCOL_SCHEMA_ENUM,
+                            std::is_signed_v< std::underlying_type_t< D > >,
+                            sizeof( D ) );
+                } else if constexpr ( std::is_signed_v< D > ) {
+                        return detail::protocol_schema_combine(
+                            detail::PROTOCOL_SCHEMA_SIGNED, sizeof( D ) );
+                } else {
+                        return detail::protocol_schema_combine(
+                            detail::PROTOCOL_SCHEMA_UNSIGNED, sizeof( D ) );
+                }
+        }();
+};
+
+template < std::floating_point D >
+struct protocol_schema< D >
+{
+        static constexpr uint32_t hash =
+            detail::protocol_schema_combine( detail::PROTOCOL_SCHEMA_FLOATING, sizeof( D ) );
+};
+
+template < typename D, std::size_t N >
+struct protocol_schema< std::array< D, N > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_ARRAY, N, protocol_schema< D >::hash );
+};
+
+template < typename... Ds >
+struct protocol_schema< std::tuple< Ds... > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_TUPLE, sizeof...( Ds ), protocol_schema< Ds >::hash... );
+};
+
+template < typename... Ds >
+struct protocol_schema< std::variant< Ds... > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_VARIANT, sizeof...( Ds ), protocol_schema< Ds >::hash... );
+};
+
+template < std::size_t N >
+struct protocol_schema< std::bitset< N > >
+{
+        static constexpr uint32_t hash =
+            detail::protocol_schema_combine( detail::PROTOCOL_SCHEMA_BITSET, N );
+};
+
+template < std::size_t N >
+struct protocol_schema< protocol_sizeless_message< N > >
+{
+        static constexpr uint32_t hash =
+            detail::protocol_schema_combine( detail::PROTOCOL_SCHEMA_BYTES, N );
+};
+
+template < std::size_t N >
+struct protocol_schema< protocol_bytes_view< N > >
+  : protocol_schema< protocol_sizeless_message< N > >
+{
+};
+
+template < typename T, std::size_t N >
+struct protocol_schema< static_vector< T, N > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_VECTOR, N, protocol_schema< T >::hash );
+};
+
+template < typename D, std::size_t N >
+struct protocol_schema< protocol_array_view< D, N > > : protocol_schema< static_vector< D, N > >
+{
+};
+
+template < typename D, auto Offset >
+struct protocol_schema< protocol_offset< D, Offset > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_OFFSET, Offset, protocol_schema< D >::hash );
+};
+
+template < quantity_derived D >
+struct protocol_schema< D >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_QUANTITY, protocol_schema< typename D::value_type >::hash );
+};
+
+template < typename D, D Min, D Max >
+struct protocol_schema< bounded< D, Min, Max > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_BOUNDED, Min, Max, protocol_schema< D >::hash );
+};
+
+template < typename CounterType, typename D >
+struct protocol_schema< protocol_sized_buffer< CounterType, D > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_SIZED_BUFFER,
+            protocol_schema< CounterType >::hash,
+            protocol_schema< D >::hash );
+};
+
+template < auto V >
+struct protocol_schema< tag< V > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_TAG, V, protocol_schema< decltype( V ) >::hash );
+};
+
+template < typename... Ds >
+struct protocol_schema< protocol_group< Ds... > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_GROUP, sizeof...( Ds ), protocol_schema< Ds >::hash... );
+};
+
+template < protocol_endianess_enum Endianess, typename D >
+struct protocol_schema< protocol_endianess< Endianess, D > >
+{
+        static constexpr uint32_t hash = detail::protocol_schema_combine(
+            detail::PROTOCOL_SCHEMA_ENDIANESS, Endianess, protocol_schema< D >::hash );
+};
+
+template < std::derived_from< protocol_def_type_base > D >
+struct protocol_schema< D > : protocol_schema< typename D::def_type >
+{
+};
+
+}  // namespace emlabcpp
@@ -1,85 +1,503 @@
 #include "emlabcpp/assert.h"
 #include "emlabcpp/either.h"
+#include "emlabcpp/protocol/stats.h"
 #include "emlabcpp/static_circular_buffer.h"
 
+#include <algorithm>
 #include <array>
+#include <concepts>
+#include <cstring>
+#include <optional>
+#include <tuple>
+#include <type_traits>
 
 #pragma once
 
 namespace emlabcpp
 {
 
+// Buffer of bytes for protocol_sequencer that keeps the stored bytes contiguous. Bytes are appended
+// at the end of the storage, once the end is reached the stored bytes are moved back to the start
+// of the storage. Removal of bytes from the front is cheap and does not move anything.
+template < std::size_t N >
+class protocol_linear_buffer
+{
+public:
+        using value_type      = uint8_t;
+        using iterator        = const uint8_t*;
+        using const_iterator  = const uint8_t*;
+        using size_type       = std::size_t;
+        using const_reference = const uint8_t&;
+
+        [[nodiscard]] const uint8_t* data() const
+        {
+                return data_.data() + from_;
+        }
+
+        [[nodiscard]] const_iterator begin() const
+        {
+                return data();
+        }
+
+        [[nodiscard]] const_iterator end() const
+        {
+                return data_.data() + to_;
+        }
+
+        [[nodiscard]] std::size_t size() const
+        {
+                return to_ - from_;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+                return to_ == from_;
+        }
+
+        [[nodiscard]] constexpr std::size_t max_size() const
+        {
+                return N;
+        }
+
+        uint8_t operator[]( std::size_t i ) const
+        {
+                return data_[from_ + i];
+        }
+
+        void push_back( uint8_t item )
+        {
+                EMLABCPP_ASSERT( size() < N );
+                if ( to_ == N ) {
+                        std::memmove( data_.data(), data(), size() );
+                        to_ -= from_;
+                        from_ = 0;
+                }
+                data_[to_] = item;
+                to_ += 1;
+        }
+
+        void pop_front( std::size_t n = 1 )
+        {
+                from_ += n;
+                if ( from_ == to_ ) {
+                        from_ = 0;
+                        to_   = 0;
+                }
+        }
+
+        // Same as static_circular_buffer::segments, the second segment is always empty
+        [[nodiscard]] std::pair< view< const uint8_t* >, view< const uint8_t* > > segments() const
+        {
+                return { view_n( data(), size() ), view_n( end(), 0 ) };
+        }
+
+private:
+        std::array< uint8_t, N > data_;
+        std::size_t              from_ = 0;
+        std::size_t              to_   = 0;
+};
+
+// Sequencer definition that also declares checksum of messages, which is stored in last
+// `checksum_size` bytes of each message. The checksum of the rest of the message is computed
+// incrementally by the sequencer with `checksum_init` and `checksum_update` as bytes arrive and
+// checked against the stored bytes by `checksum_check`. Messages that fail the check are discarded
+// as noise.
 template < typename Def >
+concept protocol_sequencer_checksum_def = requires( view< const uint8_t* > v )
+{
+        {
+                Def::checksum_size
+                } -> std::convertible_to< std::size_t >;
+        Def::checksum_update( Def::checksum_init(), v );
+        {
+                Def::checksum_check( Def::checksum_init(), v )
+                } -> std::same_as< bool >;
+};
+
+// State of the checksum kept by protocol_sequencer, empty for definitions without checksum
+template < typename Def >
+struct protocol_sequencer_checksum_state
+{
+};
+
+template < protocol_sequencer_checksum_def Def >
+struct protocol_sequencer_checksum_state< Def >
+{
+        // State of the checksum of first `checked` bytes of message at the start of buffer
+        decltype( Def::checksum_init() ) value{};
+        std::size_t                      checked = 0;
+};
+
+template < typename Def, typename Buffer, protocol_stats_policy Stats >
+class protocol_sequencer;
+
+// View of message passed out by protocol_sequencer whose definition declares checksum, the checksum
+// of the message was already verified. Only the sequencer creates these, so functions that require
+// this type can rely on the check.
+class protocol_verified_view : public view< const uint8_t* >
+{
+        template < typename Def, typename Buffer, protocol_stats_policy Stats >
+        friend class protocol_sequencer;
+
+        explicit protocol_verified_view( view< const uint8_t* > v )
+          : view< const uint8_t* >( v )
+        {
+        }
+};
+
+// Sequencer splits stream of bytes into messages defined by `Def`. Each message starts with
+// `Def::prefix` and its size is given by `Def::get_size` once `Def::fixed_size` bytes are present.
+// Bytes not belonging to any message are discarded.
+//
+// The sequencer stores bytes in `Buffer`, which is either static_circular_buffer or
+// protocol_linear_buffer. With protocol_linear_buffer messages can be also obtained as views into
+// the buffer with `load_view`, without copying them into message_type.
+//
+// In case `Def` satisfies protocol_sequencer_checksum_def, only messages with valid checksum are
+// passed out and views of messages are passed out as protocol_verified_view.
+//
+// Events of the sequencer are reported to `Stats`, see protocol_stats_policy.
+template <
+    typename Def,
+    typename Buffer = static_circular_buffer< uint8_t, Def::message_type::max_size * 2 >,
+    protocol_stats_policy Stats = protocol_no_stats >
 class protocol_sequencer
 {
 public:
         static constexpr auto        prefix     = Def::prefix;
         static constexpr std::size_t fixed_size = Def::fixed_size;
+        static constexpr bool        checksum   = protocol_sequencer_checksum_def< Def >;
 
 private:
-        static_circular_buffer< uint8_t, Def::message_type::max_size * 2 > buffer_;
+        static constexpr bool contiguous_buffer = requires( const Buffer& b )
+        {
+                {
+                        b.data()
+                        } -> std::same_as< const uint8_t* >;
+        };
+
+        Buffer buffer_;
+
+        // Size of the message last returned by `load_view`, only views into contiguous buffer are
+        // held
+        [[no_unique_address]] std::conditional_t< contiguous_buffer, std::size_t, std::tuple<> >
+            held_{};
+
+        [[no_unique_address]] protocol_sequencer_checksum_state< Def > checksum_;
+
+        [[no_unique_address]] Stats stats_;
 
 public:
         using message_type = typename Def::message_type;
+        using view_type =
+            std::conditional_t< checksum, protocol_verified_view, view< const uint8_t* > >;
 
+        // Loads the data into the internal buffer and returns the first complete message from it,
+        // or number of bytes that should be loaded next. Any further complete messages stay in the
+        // buffer until the next call.
         template < typename Iterator >
         either< std::size_t, message_type > load_data( view< Iterator > dview )
         {
-                std::copy( dview.begin(), dview.end(), std::back_inserter( buffer_ ) );
+                release();
+                push( dview.begin(), dview.size() );
+                return take_message();
+        }
 
-                auto bend = buffer_.end();
-                while ( !buffer_.empty() ) {
-                        auto [piter, biter] =
-                            std::mismatch( prefix.begin(), prefix.end(), buffer_.begin(), bend );
+        // Loads the data and passes every complete message to `f`, returns the number of bytes that
+        // should be loaded next. The data can be of any size, it is moved into the internal buffer
+        // gradually as the messages are taken out of it.
+        template < typename Iterator, typename UnaryFunction >
+        std::size_t load_data( view< Iterator > dview, UnaryFunction&& f )
+        {
+                return load_chunks( dview, [&]() -> std::optional< std::size_t > {
+                        std::optional< std::size_t > res;
+                        take_message().match(
+                            [&]( std::size_t needed ) {
+                                    res = needed;
+                            },
+                            [&]( const message_type& msg ) {
+                                    f( msg );
+                            } );
+                        return res;
+                } );
+        }
 
-                        // not match, remove one byte from buffer
-                        if ( biter == buffer_.begin() ) {
-                                buffer_.pop_front();
-                                continue;
+        // Loads the data into the internal buffer and returns view of the first complete message
+        // in the buffer, or number of bytes that should be loaded next. The message is not copied
+        // out of the buffer, the view is valid until `release()` or next load call.
+        template < typename Iterator >
+        either< std::size_t, view_type > load_view( view< Iterator > dview ) requires(
+            contiguous_buffer )
+        {
+                release();
+                push( dview.begin(), dview.size() );
+                return take_view();
+        }
+
+        // Loads the data and passes view of every complete message to `f`, returns the number of
+        // bytes that should be loaded next. Each view is valid only during the call of `f`.
+        template < typename Iterator, typename UnaryFunction >
+        std::size_t load_view( view< Iterator > dview, UnaryFunction&& f ) requires(
+            contiguous_buffer )
+        {
+                return load_chunks( dview, [&]() -> std::optional< std::size_t > {
+                        std::size_t needed = sync();
+                        if ( needed != 0 ) {
+                                return needed;
                         }
+                        std::size_t size = Def::get_size( buffer_ );
+                        stats_.on_frame( size );
+                        f( view_type{ view_n( buffer_.data(), size ) } );
+                        drop( size );
+                        return std::nullopt;
+                } );
+        }
 
-                        // partial match - more bytes could be matched
-                        if ( piter != prefix.end() && biter != bend ) {
-                                buffer_.pop_front();
-                                continue;
+        // Removes the message last returned by `load_view` from the buffer, invalidating the view.
+        void release()
+        {
+                if constexpr ( contiguous_buffer ) {
+                        drop( held_ );
+                        held_ = 0;
+                }
+        }
+
+        Stats& stats()
+        {
+                return stats_;
+        }
+
+        const Stats& stats() const
+        {
+                return stats_;
+        }
+
+private:
+        template < typename Iterator >
+        void push( Iterator iter, std::size_t n )
+        {
+                std::copy_n( iter, n, std::back_inserter( buffer_ ) );
+                stats_.on_load( n );
+                stats_.on_buffer_usage( buffer_.size() );
+        }
+
+        // Moves the data into the buffer in chunks that fit into it and calls `take` until it
+        // returns number of bytes needed, which is returned from the last chunk.
+        template < typename Iterator, typename TakeFunction >
+        std::size_t load_chunks( view< Iterator > dview, TakeFunction&& take )
+        {
+                release();
+                auto iter = dview.begin();
+                while ( true ) {
+                        std::size_t n = std::min(
+                            buffer_.max_size() - buffer_.size(),
+                            static_cast< std::size_t >( std::distance( iter, dview.end() ) ) );
+                        push( iter, n );
+                        std::advance( iter, n );
+
+                        std::optional< std::size_t > opt_needed;
+                        while ( !opt_needed ) {
+                                opt_needed = take();
                         }
 
-                        // partial match - matched maximum bytes available
-                        if ( piter != prefix.end() ) {
-                                return fixed_size - static_cast< std::size_t >(
-                                                        std::distance( prefix.begin(), piter ) );
+                        // Buffer can always hold at least one message, so it is never full with
+                        // incomplete message and each iteration loads some data
+                        if ( iter == dview.end() ) {
+                                return *opt_needed;
                         }
+                }
+        }
 
-                        break;
+        either< std::size_t, message_type > take_message()
+        {
+                std::size_t needed = sync();
+                if ( needed != 0 ) {
+                        return needed;
                 }
+                std::size_t size    = Def::get_size( buffer_ );
+                auto        opt_msg = message_type::make( view_n( buffer_.begin(), size ) );
+                stats_.on_frame( size );
+                EMLABCPP_ASSERT( opt_msg );
+
+                // clean up only the matched message
+                drop( size );
+
+                return *opt_msg;
+        }
+
+        either< std::size_t, view_type > take_view()
+        {
+                std::size_t needed = sync();
+                if ( needed != 0 ) {
+                        return needed;
+                }
+                held_ = Def::get_size( buffer_ );
+                stats_.on_frame( held_ );
+                return view_type{ view_n( buffer_.data(), held_ ) };
+        }
+
+        // Discards bytes from the buffer until complete message is at its start, returns 0 in that
+        // case. Otherwise returns number of bytes that are missing for the next message.
+        std::size_t sync()
+        {
+                while ( true ) {
+                        auto bend = buffer_.end();
+                        while ( !buffer_.empty() ) {
+                                discard_until_prefix_start();
+                                if ( buffer_.empty() ) {
+                                        break;
+                                }
+
+                                auto [piter, biter] = std::mismatch(
+                                    prefix.begin(), prefix.end(), buffer_.begin(), bend );
+
+                                // partial match - more bytes could be matched
+                                if ( piter != prefix.end() && biter != bend ) {
+                                        discard( 1 );
+                                        continue;
+                                }
+
+                                // partial match - matched maximum bytes available
+                                if ( piter != prefix.end() ) {
+                                        return fixed_size -
+                                               static_cast< std::size_t >(
+                                                   std::distance( prefix.begin(), piter ) );
+                                }
+
+                                break;
+                        }
+
+                        if ( buffer_.empty() ) {
+                                return fixed_size;
+                        }
 
-                if ( buffer_.empty() ) {
-                        return fixed_size;
+                        std::size_t bsize = buffer_.size();
+
+                        // This is implied by the fact that we should have full match at the start
+                        // of buffer
+                        EMLABCPP_ASSERT( bsize >= prefix.size() );
+
+                        if ( bsize < fixed_size ) {
+                                return fixed_size - bsize;
+                        }
+
+                        std::size_t desired_size = Def::get_size( buffer_ );
+
+                        // The size can't be valid, the prefix was just part of noise. Message
+                        // shorter than its fixed part would also be taken out without consuming
+                        // any bytes.
+                        if ( desired_size > message_type::max_size ||
+                             desired_size < std::max( fixed_size, checksum_size() ) ) {
+                                discard( 1 );
+                                continue;
+                        }
+
+                        if constexpr ( checksum ) {
+                                fold_checksum(
+                                    std::min( bsize, desired_size - Def::checksum_size ) );
+                        }
+
+                        if ( bsize < desired_size ) {
+                                return desired_size - bsize;
+                        }
+
+                        if constexpr ( checksum ) {
+                                // Invalid checksum, the message was also just part of noise
+                                if ( !check_checksum( desired_size ) ) {
+                                        stats_.on_checksum_failure();
+                                        discard( 1 );
+                                        continue;
+                                }
+                        }
+
+                        return 0;
                 }
+        }
 
-                std::size_t bsize = buffer_.size();
+        // Discards all bytes before the first occurence of the first byte of prefix in one step.
+        // The search is done by memchr over the contiguous segments of the buffer.
+        void discard_until_prefix_start()
+        {
+                if constexpr ( prefix.size() > 0 ) {
+                        auto [first, second] = buffer_.segments();
 
-                // This is implied by the fact that we should have full match at the start of buffer
-                EMLABCPP_ASSERT( bsize >= prefix.size() );
+                        std::size_t skip = 0;
+                        for ( const view< const uint8_t* >& seg : { first, second } ) {
+                                const void* pos = std::memchr( seg.begin(), prefix[0], seg.size() );
+                                if ( pos != nullptr ) {
+                                        skip += static_cast< std::size_t >(
+                                            static_cast< const uint8_t* >( pos ) - seg.begin() );
+                                        discard( skip );
+                                        return;
+                                }
+                                skip += seg.size();
+                        }
+                        discard( skip );
+                }
+        }
 
-                if ( bsize < fixed_size ) {
-                        return fixed_size - bsize;
+        // Removes `n` bytes from the start of the buffer, checksum of the message at the start is
+        // no longer valid.
+        void drop( std::size_t n )
+        {
+                if ( n == 0 ) {
+                        return;
+                }
+                buffer_.pop_front( n );
+                if constexpr ( checksum ) {
+                        checksum_.checked = 0;
                 }
+        }
 
-                std::size_t desired_size = Def::get_size( buffer_ );
-                if ( bsize < desired_size ) {
-                        return desired_size - bsize;
+        // Removes `n` bytes that are not part of any message
+        void discard( std::size_t n )
+        {
+                stats_.on_discard( n );
+                drop( n );
+        }
+
+        static constexpr std::size_t checksum_size()
+        {
+                if constexpr ( checksum ) {
+                        return Def::checksum_size;
+                } else {
+                        return 0;
                 }
+        }
 
-                auto opt_msg = message_type::make( view_n( buffer_.begin(), desired_size ) );
-                EMLABCPP_ASSERT( opt_msg );
+        // Adds bytes of the message at the start of the buffer up to offset `to` to the checksum
+        void fold_checksum( std::size_t to )
+        {
+                std::size_t& checked = checksum_.checked;
+                if ( checked == 0 ) {
+                        checksum_.value = Def::checksum_init();
+                }
+                auto [first, second] = buffer_.segments();
 
-                // clean up only the matched message
-                for ( std::size_t i = desired_size; i > 0; i-- ) {
-                        buffer_.pop_front();
+                std::size_t offset = 0;
+                for ( const view< const uint8_t* >& seg : { first, second } ) {
+                        std::size_t seg_end = offset + seg.size();
+                        if ( checked < to && checked < seg_end ) {
+                                std::size_t n   = std::min( to, seg_end ) - checked;
+                                checksum_.value = Def::checksum_update(
+                                    checksum_.value,
+                                    view_n( seg.begin() + ( checked - offset ), n ) );
+                                checked += n;
+                        }
+                        offset = seg_end;
                 }
+        }
 
-                return *opt_msg;
+        // Checks the checksum of complete message of `size` bytes at the start of the buffer
+        bool check_checksum( std::size_t size )
+        {
+                std::array< uint8_t, Def::checksum_size > present;
+                std::copy_n(
+                    buffer_.begin() + static_cast< std::ptrdiff_t >( size - Def::checksum_size ),
+                    Def::checksum_size,
+                    present.begin() );
+                return Def::checksum_check(
+                    checksum_.value, view_n( present.data(), present.size() ) );
         }
 };
 
@@ -108,4 +526,8 @@ protocol_simple_load( std::size_t read_limit, ReadCallback&& read )
         return res;
 }
 
+template < typename Def >
+using protocol_view_sequencer =
+    protocol_sequencer< Def, protocol_linear_buffer< Def::message_type::max_size * 2 > >;
+
 }  // namespace emlabcpp
@@ -1,7 +1,10 @@
 #include "emlabcpp/bounded_view.h"
 #include "emlabcpp/iterators/numeric.h"
 #include "emlabcpp/protocol/base.h"
+#include "emlabcpp/types.h"
 
+#include <bit>
+#include <cstring>
 #include <span>
 
 #pragma once
@@ -9,6 +12,26 @@
 namespace emlabcpp
 {
 
+namespace detail
+{
+        // Reverses order of bytes in the unsigned word `v`, compiles down to single instruction on
+        // most of the platforms.
+        template < typename UT >
+        constexpr UT protocol_byteswap( UT v )
+        {
+                if constexpr ( sizeof( UT ) == 1 ) {
+                        return v;
+                } else if constexpr ( sizeof( UT ) == 2 ) {
+                        return __builtin_bswap16( v );
+                } else if constexpr ( sizeof( UT ) == 4 ) {
+                        return __builtin_bswap32( v );
+                } else {
+                        static_assert( sizeof( UT ) == 8 );
+                        return __builtin_bswap64( v );
+                }
+        }
+}  // namespace detail
+
 template < protocol_base_type T, protocol_endianess_enum Endianess >
 struct protocol_serializer
 {
@@ -17,25 +40,49 @@ struct protocol_serializer
         using view_type                       = bounded_view< const uint8_t*, size_type >;
         static constexpr bool is_big_endian   = Endianess == PROTOCOL_BIG_ENDIAN;
 
+        // Outside of constant evaluation the value is copied as whole word into the buffer, bytes
+        // are swapped only in case the endianess of the message differs from the endianess of the
+        // host.
+        using word_type                      = select_utype_t< max_size >;
+        static constexpr bool requires_swap =
+            is_big_endian != ( std::endian::native == std::endian::big );
+
         static constexpr auto& bget( auto& buffer, std::size_t i )
         {
                 return buffer[is_big_endian ? i : max_size - 1 - i];
         }
         static constexpr void serialize_at( std::span< uint8_t, max_size > buffer, T item )
         {
-                for ( std::size_t i : range( max_size ) ) {
-                        bget( buffer, max_size - i - 1 ) = static_cast< uint8_t >( item & 0xFF );
-                        item                             = static_cast< T >( item >> 8 );
+                if ( std::is_constant_evaluated() ) {
+                        for ( std::size_t i : range( max_size ) ) {
+                                bget( buffer, max_size - i - 1 ) =
+                                    static_cast< uint8_t >( item & 0xFF );
+                                item = static_cast< T >( item >> 8 );
+                        }
+                        return;
+                }
+                auto word = std::bit_cast< word_type >( item );
+                if constexpr ( requires_swap ) {
+                        word = detail::protocol_byteswap( word );
                 }
+                std::memcpy( buffer.data(), &word, max_size );
         }
         static constexpr T deserialize( const view_type& buffer )
         {
-                T res{};
-                for ( std::size_t i : range( max_size ) ) {
-                        res = static_cast< T >( res << 8 );
-                        res = static_cast< T >( res | bget( buffer, i ) );
+                if ( std::is_constant_evaluated() ) {
+                        T res{};
+                        for ( std::size_t i : range( max_size ) ) {
+                                res = static_cast< T >( res << 8 );
+                                res = static_cast< T >( res | bget( buffer, i ) );
+                        }
+                        return { res };
+                }
+                word_type word;
+                std::memcpy( &word, buffer.begin(), max_size );
+                if constexpr ( requires_swap ) {
+                        word = detail::protocol_byteswap( word );
                 }
-                return { res };
+                return std::bit_cast< T >( word );
         }
 };
 
@@ -56,4 +103,45 @@ struct protocol_serializer< bool, Endianess >
         }
 };
 
+// Serializes continuous sequence of `n` values of type T at once. If the endianess of the message
+// matches the endianess of the host, this is single memcpy, otherwise the values are byte-swapped
+// in a simple loop over words that the compiler is able to vectorize.
+template < typename T, protocol_endianess_enum Endianess >
+struct protocol_bulk_serializer
+{
+        static constexpr std::size_t item_size = sizeof( T );
+        using word_type                        = select_utype_t< item_size >;
+        static constexpr bool requires_swap =
+            item_size != 1 &&
+            ( Endianess == PROTOCOL_BIG_ENDIAN ) != ( std::endian::native == std::endian::big );
+
+        static void serialize_at( uint8_t* target, const T* source, std::size_t n )
+        {
+                if constexpr ( !requires_swap ) {
+                        std::memcpy( target, source, n * item_size );
+                } else {
+                        for ( std::size_t i : range( n ) ) {
+                                word_type word;
+                                std::memcpy( &word, source + i, item_size );
+                                word = detail::protocol_byteswap( word );
+                                std::memcpy( target + i * item_size, &word, item_size );
+                        }
+                }
+        }
+
+        static void deserialize( const uint8_t* source, T* target, std::size_t n )
+        {
+                if constexpr ( !requires_swap ) {
+                        std::memcpy( target, source, n * item_size );
+                } else {
+                        for ( std::size_t i : range( n ) ) {
+                                word_type word;
+                                std::memcpy( &word, source + i * item_size, item_size );
+                                word = detail::protocol_byteswap( word );
+                                std::memcpy( target + i, &word, item_size );
+                        }
+                }
+        }
+};
+
 }  // namespace emlabcpp
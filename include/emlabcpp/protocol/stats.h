@@ -0,0 +1,152 @@
+#include "emlabcpp/protocol/error.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+
+#pragma once
+
+namespace emlabcpp
+{
+
+// Statistics policy of protocol_sequencer and protocol_packet_handler, these call the methods of
+// the policy on each event:
+//  - on_load( n ): `n` bytes were loaded into the sequencer
+//  - on_discard( n ): `n` bytes were discarded by the sequencer as noise
+//  - on_frame( n ): the sequencer passed out complete message of `n` bytes
+//  - on_buffer_usage( n ): the sequencer buffer holds `n` bytes
+//  - on_checksum_failure(): the message had invalid checksum
+//  - on_error( rec ): the message could not be extracted because of error `rec`
+template < typename T >
+concept protocol_stats_policy =
+    requires( T s, std::size_t n, const protocol_error_record& rec )
+{
+        s.on_load( n );
+        s.on_discard( n );
+        s.on_frame( n );
+        s.on_buffer_usage( n );
+        s.on_checksum_failure();
+        s.on_error( rec );
+};
+
+// Policy that does not count anything, the calls are optimized out and the policy takes no space
+struct protocol_no_stats
+{
+        constexpr void on_load( std::size_t )
+        {
+        }
+        constexpr void on_discard( std::size_t )
+        {
+        }
+        constexpr void on_frame( std::size_t )
+        {
+        }
+        constexpr void on_buffer_usage( std::size_t )
+        {
+        }
+        constexpr void on_checksum_failure()
+        {
+        }
+        constexpr void on_error( const protocol_error_record& )
+        {
+        }
+};
+
+struct protocol_mark_count
+{
+        protocol_mark mark;
+        std::size_t   count;
+};
+
+// Values of counters of protocol_stats at one point in time, plain structure that can be copied
+// and exported as is.
+template < std::size_t MarkSlots >
+struct protocol_stats_snapshot
+{
+        std::size_t bytes_loaded      = 0;
+        std::size_t bytes_discarded   = 0;
+        std::size_t frames            = 0;
+        std::size_t checksum_failures = 0;
+        std::size_t buffer_high_water = 0;
+
+        // count of errors for each mark, first `used_marks` items are valid
+        std::array< protocol_mark_count, MarkSlots > marks{};
+        std::size_t                                  used_marks = 0;
+        // errors with marks that did not fit into `marks`
+        std::size_t other_errors = 0;
+
+        [[nodiscard]] std::size_t error_count( const protocol_mark& mark ) const
+        {
+                auto end  = marks.begin() + static_cast< std::ptrdiff_t >( used_marks );
+                auto iter = std::find_if( marks.begin(), end, [&]( const protocol_mark_count& mc ) {
+                        return mc.mark == mark;
+                } );
+                return iter == end ? 0 : iter->count;
+        }
+};
+
+// Policy that counts all events, errors are counted for up to `MarkSlots` distinct marks
+template < std::size_t MarkSlots = 8 >
+class protocol_stats
+{
+public:
+        using snapshot_type = protocol_stats_snapshot< MarkSlots >;
+
+        void on_load( std::size_t n )
+        {
+                data_.bytes_loaded += n;
+        }
+
+        void on_discard( std::size_t n )
+        {
+                data_.bytes_discarded += n;
+        }
+
+        void on_frame( std::size_t )
+        {
+                data_.frames += 1;
+        }
+
+        void on_buffer_usage( std::size_t n )
+        {
+                data_.buffer_high_water = std::max( data_.buffer_high_water, n );
+        }
+
+        void on_checksum_failure()
+        {
+                data_.checksum_failures += 1;
+        }
+
+        void on_error( const protocol_error_record& rec )
+        {
+                auto beg  = data_.marks.begin();
+                auto end  = beg + static_cast< std::ptrdiff_t >( data_.used_marks );
+                auto iter = std::find_if( beg, end, [&]( const protocol_mark_count& mc ) {
+                        return mc.mark == rec.mark;
+                } );
+                if ( iter != end ) {
+                        iter->count += 1;
+                } else if ( data_.used_marks < MarkSlots ) {
+                        *iter = protocol_mark_count{ rec.mark, 1 };
+                        data_.used_marks += 1;
+                } else {
+                        data_.other_errors += 1;
+                }
+        }
+
+        [[nodiscard]] snapshot_type snapshot() const
+        {
+                return data_;
+        }
+
+        void reset()
+        {
+                data_ = snapshot_type{};
+        }
+
+private:
+        snapshot_type data_;
+};
+
+}  // namespace emlabcpp
@@ -2,6 +2,7 @@
 
 #include "emlabcpp/iterators/numeric.h"
 #include "emlabcpp/protocol/base.h"
+#include "emlabcpp/protocol/lazy_array.h"
 #include "emlabcpp/protocol/register_map.h"
 
 #include <iomanip>
@@ -47,6 +48,11 @@ inline std::ostream& operator<<( std::ostream& os, const protocol_error_record&
         return os << rec.mark << "(" << rec.offset << ")";
 }
 
+inline std::ostream& operator<<( std::ostream& os, const protocol_batch_error_record& rec )
+{
+        return os << rec.rec << " in record " << rec.index;
+}
+
 inline std::ostream& operator<<( std::ostream& os, const protocol_endianess_enum& val )
 {
         switch ( val ) {
@@ -58,6 +64,18 @@ inline std::ostream& operator<<( std::ostream& os, const protocol_endianess_enum
         return os;
 }
 
+template < typename D >
+inline std::ostream& operator<<( std::ostream& os, const protocol_lazy_array< D >& arr )
+{
+        for ( std::size_t i : range( arr.size() ) ) {
+                if ( i != 0 ) {
+                        os << ',';
+                }
+                os << arr[i];
+        }
+        return os;
+}
+
 template < protocol_endianess_enum Endianess, typename... Regs >
 inline std::ostream&
 operator<<( std::ostream& os, const protocol_register_map< Endianess, Regs... >& m )
@@ -89,6 +107,12 @@ operator<<( std::ostream& os, const protocol_register_map< Endianess, Regs... >&
         return os;
 }
 
+template < typename Map >
+inline std::ostream& operator<<( std::ostream& os, const protocol_tracked_register_map< Map >& m )
+{
+        return os << m.map();
+}
+
 }  // namespace emlabcpp
 
 #endif
@@ -123,6 +123,29 @@ public:
                 from_ = next( from_ );
         }
 
+        // Removes `n` items from the front of the buffer, `n` has to be at most size().
+        void pop_front( size_type n )
+        {
+                if constexpr ( std::is_trivially_destructible_v< T > ) {
+                        from_ = ( from_ + n ) % real_size;
+                } else {
+                        for ( ; n > 0; n-- ) {
+                                pop_front();
+                        }
+                }
+        }
+
+        // Returns the items as up to two contiguous segments of the underlying storage, the second
+        // one is empty unless the stored items wrap around the end of the storage.
+        [[nodiscard]] std::pair< view< const T* >, view< const T* > > segments() const
+        {
+                const T* data = std::addressof( ref_item( 0 ) );
+                if ( to_ >= from_ ) {
+                        return { view_n( data + from_, to_ - from_ ), view_n( data, 0 ) };
+                }
+                return { view_n( data + from_, real_size - from_ ), view_n( data, to_ ) };
+        }
+
         // methods for handling the back side of the circular buffer
 
         [[nodiscard]] iterator end()
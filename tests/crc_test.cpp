@@ -0,0 +1,102 @@
+#include "emlabcpp/crc.h"
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+constexpr std::array< uint8_t, 9 > check_bytes = {
+    '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+constexpr view< const uint8_t* > check_data = view_n( check_bytes.data(), check_bytes.size() );
+
+// Bit by bit calculation of the CRC as reference
+template < typename Crc >
+typename Crc::value_type bitwise_crc( const std::vector< uint8_t >& data )
+{
+        using value_type = typename Crc::value_type;
+        constexpr auto top = static_cast< value_type >( value_type{ 1 } << ( Crc::width - 1 ) );
+
+        value_type rpoly = 0;
+        for ( std::size_t i = 0; i < Crc::width; i++ ) {
+                if ( ( Crc::poly >> i ) & 1 ) {
+                        rpoly = static_cast< value_type >(
+                            rpoly | ( value_type{ 1 } << ( Crc::width - 1 - i ) ) );
+                }
+        }
+
+        value_type reg = Crc::init();
+        for ( uint8_t byte : data ) {
+                for ( std::size_t i = 0; i < 8; i++ ) {
+                        bool bit;
+                        if constexpr ( Crc::reflected ) {
+                                bit = ( ( reg ^ ( byte >> i ) ) & 1 ) != 0;
+                                reg = static_cast< value_type >( reg >> 1 );
+                                if ( bit ) {
+                                        reg = static_cast< value_type >( reg ^ rpoly );
+                                }
+                        } else {
+                                bit = ( ( reg & top ) != 0 ) != ( ( byte & ( 0x80 >> i ) ) != 0 );
+                                reg = static_cast< value_type >( reg << 1 );
+                                if ( bit ) {
+                                        reg = static_cast< value_type >( reg ^ Crc::poly );
+                                }
+                        }
+                }
+        }
+        return Crc::finalize( reg );
+}
+
+template < typename Crc >
+void check_against_bitwise()
+{
+        std::vector< uint8_t > data( 100 );
+        for ( std::size_t i = 0; i < data.size(); i++ ) {
+                data[i] = static_cast< uint8_t >( i * 37 + 11 );
+        }
+        for ( std::size_t n = 0; n <= data.size(); n++ ) {
+                std::vector< uint8_t > part( data.begin(), data.begin() + static_cast< int >( n ) );
+                auto                   res = Crc::compute( view_n( part.data(), part.size() ) );
+                EXPECT_EQ( res, bitwise_crc< Crc >( part ) ) << n;
+        }
+}
+
+}  // namespace
+
+TEST( crc, check )
+{
+        static_assert( crc8::compute( check_data ) == 0xF4 );
+        static_assert( crc16_ccitt::compute( check_data ) == 0x29B1 );
+        static_assert( crc32::compute( check_data ) == 0xCBF43926 );
+        static_assert( crc32c::compute( check_data ) == 0xE3069283 );
+
+        EXPECT_EQ( crc8::compute( check_data ), 0xF4 );
+        EXPECT_EQ( crc16_ccitt::compute( check_data ), 0x29B1 );
+        EXPECT_EQ( crc32::compute( check_data ), 0xCBF43926 );
+        EXPECT_EQ( crc32c::compute( check_data ), 0xE3069283 );
+}
+
+TEST( crc, bitwise )
+{
+        check_against_bitwise< crc8 >();
+        check_against_bitwise< crc16_ccitt >();
+        check_against_bitwise< crc32 >();
+        check_against_bitwise< crc32c >();
+}
+
+TEST( crc, incremental )
+{
+        std::vector< uint8_t > data( 64 );
+        std::iota( data.begin(), data.end(), uint8_t{ 0 } );
+
+        uint32_t expected = crc32c::compute( view_n( data.data(), data.size() ) );
+        for ( std::size_t split = 0; split <= data.size(); split++ ) {
+                uint32_t reg = crc32c::init();
+                reg          = crc32c::update( reg, view_n( data.data(), split ) );
+                reg = crc32c::update( reg, view_n( data.data() + split, data.size() - split ) );
+                EXPECT_EQ( crc32c::finalize( reg ), expected ) << split;
+        }
+}
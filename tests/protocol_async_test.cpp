@@ -0,0 +1,267 @@
+#include "emlabcpp/experimental/epoll.h"
+#include "emlabcpp/protocol/async.h"
+#include "emlabcpp/protocol/message.h"
+#include "emlabcpp/protocol/streams.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+struct sequencer_def
+{
+        using message_type = protocol_message< 16 >;
+
+        static constexpr std::array< uint8_t, 2 > prefix     = { 0x44, 0x44 };
+        static constexpr std::size_t              fixed_size = 3;
+
+        static constexpr std::size_t get_size( const auto& bview )
+        {
+                return bview[2] + fixed_size;
+        }
+};
+
+using sequencer    = protocol_sequencer< sequencer_def >;
+using message_type = typename sequencer::message_type;
+
+// Local pipe that stands in for the link to device
+struct test_pipe
+{
+        std::array< int, 2 > fds;
+
+        test_pipe()
+        {
+                EXPECT_EQ( pipe( fds.data() ), 0 );
+        }
+
+        void write_bytes( std::vector< uint8_t > data ) const
+        {
+                EXPECT_EQ( write( fds[1], data.data(), data.size() ),
+                           static_cast< ssize_t >( data.size() ) );
+        }
+
+        void close_write()
+        {
+                close( fds[1] );
+                fds[1] = -1;
+        }
+
+        ~test_pipe()
+        {
+                for ( int fd : fds ) {
+                        if ( fd != -1 ) {
+                                close( fd );
+                        }
+                }
+        }
+};
+
+}  // namespace
+
+TEST( protocol_async, pipes )
+{
+        epoll_loop                     loop;
+        std::array< test_pipe, 3 >     pipes;
+        std::vector< epoll_fd_source > sources;
+        for ( test_pipe& p : pipes ) {
+                sources.emplace_back( loop, p.fds[0] );
+        }
+
+        std::vector< protocol_task< std::optional< message_type > > > tasks;
+        for ( epoll_fd_source& source : sources ) {
+                tasks.push_back( async_load< sequencer >( source ) );
+                tasks.back().start();
+        }
+        for ( auto& t : tasks ) {
+                EXPECT_FALSE( t.done() );
+        }
+
+        // the messages arrive in parts and interleaved
+        pipes[1].write_bytes( { 0x32, 0x44, 0x44 } );
+        pipes[0].write_bytes( { 0x44, 0x44, 0x01 } );
+        loop.run_once( 100 );
+        EXPECT_FALSE( tasks[0].done() );
+        EXPECT_FALSE( tasks[1].done() );
+
+        pipes[0].write_bytes( { 0x42 } );
+        pipes[1].write_bytes( { 0x02, 0x01, 0x02 } );
+        while ( !tasks[0].done() || !tasks[1].done() ) {
+                ASSERT_GT( loop.run_once( 100 ), 0u );
+        }
+        EXPECT_FALSE( tasks[2].done() );
+
+        ASSERT_TRUE( tasks[0].result() );
+        EXPECT_EQ( *tasks[0].result(), ( message_type{ 0x44, 0x44, 0x01, 0x42 } ) );
+        ASSERT_TRUE( tasks[1].result() );
+        EXPECT_EQ( *tasks[1].result(), ( message_type{ 0x44, 0x44, 0x02, 0x01, 0x02 } ) );
+
+        // closed source ends the load without message
+        pipes[2].write_bytes( { 0x44, 0x44 } );
+        pipes[2].close_write();
+        while ( !tasks[2].done() ) {
+                ASSERT_GT( loop.run_once( 100 ), 0u );
+        }
+        EXPECT_FALSE( tasks[2].result() );
+}
+
+namespace
+{
+
+protocol_task< std::size_t > count_messages( epoll_fd_source& source )
+{
+        std::size_t count = 0;
+        while ( auto opt_msg = co_await async_load< sequencer >( source ) ) {
+                count += 1;
+        }
+        co_return count;
+}
+
+}  // namespace
+
+TEST( protocol_async, nested )
+{
+        epoll_loop      loop;
+        test_pipe       p;
+        epoll_fd_source source{ loop, p.fds[0] };
+
+        auto task = count_messages( source );
+        task.start();
+
+        for ( uint8_t i = 0; i < 5; i++ ) {
+                p.write_bytes( { 0x44, 0x44, 0x01, i } );
+                loop.run_once( 100 );
+        }
+        p.close_write();
+        while ( !task.done() ) {
+                ASSERT_GT( loop.run_once( 100 ), 0u );
+        }
+        EXPECT_EQ( task.result(), 5u );
+}
+
+namespace
+{
+
+protocol_task< bool > wait_readable( epoll_loop& loop, int fd )
+{
+        co_return co_await loop.readable( fd );
+}
+
+// Source that never has bytes available and waits for invalid fd
+struct invalid_fd_source
+{
+        epoll_loop& loop;
+
+        std::optional< std::size_t > read_some( std::span< uint8_t > )
+        {
+                return 0;
+        }
+
+        epoll_loop::readable_awaiter readable()
+        {
+                return loop.readable( -1 );
+        }
+};
+
+}  // namespace
+
+TEST( protocol_async, invalid_fd )
+{
+        epoll_loop loop;
+        ASSERT_TRUE( loop.is_open() );
+
+        // failed registration resumes the coroutine right away instead of leaving it suspended
+        auto wait = wait_readable( loop, -1 );
+        wait.start();
+        ASSERT_TRUE( wait.done() );
+        EXPECT_FALSE( wait.result() );
+
+        invalid_fd_source source{ loop };
+        auto              task = async_load< sequencer >( source );
+        task.start();
+        ASSERT_TRUE( task.done() );
+        EXPECT_FALSE( task.result() );
+
+        epoll_fd_source fd_source{ loop, -1 };
+        auto            fd_task = async_load< sequencer >( fd_source );
+        fd_task.start();
+        ASSERT_TRUE( fd_task.done() );
+        EXPECT_FALSE( fd_task.result() );
+
+        // valid fd is still waited for
+        test_pipe p;
+        auto      valid = wait_readable( loop, p.fds[0] );
+        valid.start();
+        EXPECT_FALSE( valid.done() );
+        p.write_bytes( { 0x01 } );
+        EXPECT_EQ( loop.run_once( 100 ), 1u );
+        ASSERT_TRUE( valid.done() );
+        EXPECT_TRUE( valid.result() );
+}
+
+TEST( protocol_async, destroyed_task )
+{
+        epoll_loop      loop;
+        test_pipe       p;
+        epoll_fd_source source{ loop, p.fds[0] };
+
+        // task destroyed while it waits is not resumed once the fd becomes readable
+        {
+                auto task = async_load< sequencer >( source );
+                task.start();
+                EXPECT_FALSE( task.done() );
+        }
+        p.write_bytes( { 0x44, 0x44, 0x01, 0x42 } );
+        EXPECT_EQ( loop.run_once( 10 ), 0u );
+
+        // the fd can be waited for again afterwards
+        auto task = async_load< sequencer >( source );
+        task.start();
+        while ( !task.done() ) {
+                ASSERT_GT( loop.run_once( 100 ), 0u );
+        }
+        ASSERT_TRUE( task.result() );
+        EXPECT_EQ( *task.result(), ( message_type{ 0x44, 0x44, 0x01, 0x42 } ) );
+}
+
+namespace
+{
+
+// Waits for the fd and destroys the other task once resumed
+protocol_task< bool > destroy_other(
+    epoll_loop&                                                     loop,
+    int                                                             fd,
+    std::optional< protocol_task< std::optional< message_type > > >& other )
+{
+        bool res = co_await loop.readable( fd );
+        other.reset();
+        co_return res;
+}
+
+}  // namespace
+
+TEST( protocol_async, destroyed_in_same_batch )
+{
+        epoll_loop      loop;
+        test_pipe       p1;
+        test_pipe       p2;
+        epoll_fd_source source{ loop, p2.fds[0] };
+
+        std::optional< protocol_task< std::optional< message_type > > > other;
+        other.emplace( async_load< sequencer >( source ) );
+        other->start();
+
+        auto destroyer = destroy_other( loop, p1.fds[0], other );
+        destroyer.start();
+
+        // both fds are ready in one batch, whichever order the events come in the destroyed task
+        // is never resumed
+        p2.write_bytes( { 0x44, 0x44, 0x01, 0x42 } );
+        p1.write_bytes( { 0x01 } );
+        std::size_t resumed = loop.run_once( 100 );
+        EXPECT_GE( resumed, 1u );
+        ASSERT_TRUE( destroyer.done() );
+        EXPECT_FALSE( other );
+}
@@ -1,4 +1,5 @@
 #include "emlabcpp/protocol/message.h"
+#include "emlabcpp/protocol/serializer.h"
 #include "emlabcpp/view.h"
 
 #include <gtest/gtest.h>
@@ -18,3 +19,43 @@ TEST( Protocol, message_conversion )
 
         EXPECT_EQ( view_n( buff.begin() + 4, 4 ), view{ suffix } );
 }
+
+template < typename T, protocol_endianess_enum Endianess >
+constexpr std::array< uint8_t, sizeof( T ) > constexpr_serialize( T val )
+{
+        std::array< uint8_t, sizeof( T ) > res{};
+        protocol_serializer< T, Endianess >::serialize_at( res, val );
+        return res;
+}
+
+// NOLINTNEXTLINE
+TEST( Protocol, serializer_word )
+{
+        static constexpr uint32_t val = 0x01020304;
+
+        static constexpr auto cbig = constexpr_serialize< uint32_t, PROTOCOL_BIG_ENDIAN >( val );
+        static_assert( cbig == std::array< uint8_t, 4 >{ 0x01, 0x02, 0x03, 0x04 } );
+
+        static constexpr auto clittle =
+            constexpr_serialize< uint32_t, PROTOCOL_LITTLE_ENDIAN >( val );
+        static_assert( clittle == std::array< uint8_t, 4 >{ 0x04, 0x03, 0x02, 0x01 } );
+
+        std::array< uint8_t, 4 > big{};
+        protocol_serializer< uint32_t, PROTOCOL_BIG_ENDIAN >::serialize_at( big, val );
+        EXPECT_EQ( big, cbig );
+        EXPECT_EQ(
+            ( protocol_serializer< uint32_t, PROTOCOL_BIG_ENDIAN >::deserialize( big ) ), val );
+
+        std::array< uint8_t, 4 > little{};
+        protocol_serializer< uint32_t, PROTOCOL_LITTLE_ENDIAN >::serialize_at( little, val );
+        EXPECT_EQ( little, clittle );
+        EXPECT_EQ(
+            ( protocol_serializer< uint32_t, PROTOCOL_LITTLE_ENDIAN >::deserialize( little ) ),
+            val );
+
+        std::array< uint8_t, 8 > sbig{};
+        protocol_serializer< int64_t, PROTOCOL_BIG_ENDIAN >::serialize_at( sbig, -2 );
+        EXPECT_EQ( sbig, ( std::array< uint8_t, 8 >{ 255, 255, 255, 255, 255, 255, 255, 254 } ) );
+        EXPECT_EQ(
+            ( protocol_serializer< int64_t, PROTOCOL_BIG_ENDIAN >::deserialize( sbig ) ), -2 );
+}
@@ -0,0 +1,153 @@
+#include "emlabcpp/experimental/capture.h"
+#include "emlabcpp/protocol/packet.h"
+#include "emlabcpp/protocol/packet_handler.h"
+
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+struct capture_packet_def : protocol_packet_crc< crc16_ccitt >
+{
+        static constexpr protocol_endianess_enum  endianess = PROTOCOL_BIG_ENDIAN;
+        static constexpr std::array< uint8_t, 2 > prefix    = { 0x42, 0x24 };
+        using size_type                                     = uint8_t;
+};
+
+using payload = protocol_tuple< PROTOCOL_BIG_ENDIAN, uint32_t, uint8_t >;
+using packet  = protocol_packet< capture_packet_def, payload >;
+using handler = protocol_packet_handler< packet >;
+
+struct capture_file_test : ::testing::Test
+{
+        std::filesystem::path path =
+            std::filesystem::temp_directory_path() /
+            ( "emlabcpp_capture_" + std::to_string( getpid() ) + ".bin" );
+
+        ~capture_file_test() override
+        {
+                std::filesystem::remove( path );
+        }
+};
+
+}  // namespace
+
+TEST_F( capture_file_test, replay )
+{
+        std::vector< uint8_t > stream;
+        for ( uint32_t i = 0; i < 10; i++ ) {
+                auto msg = handler::serialize( { i, uint8_t{ 42 } } );
+                stream.insert( stream.end(), msg.begin(), msg.end() );
+        }
+        // each message has 10 bytes, corrupt checksum of the fourth message
+        stream[3 * 10 + 9] ^= 0x01;
+        // noise in the middle of stream
+        stream.insert( stream.begin() + 5 * 10, { 0x01, 0x02, 0x03 } );
+
+        {
+                protocol_capture_writer writer{ path.c_str() };
+                ASSERT_TRUE( writer.is_open() );
+                for ( std::size_t i = 0; i < stream.size(); i += 7 ) {
+                        std::size_t n = std::min< std::size_t >( 7, stream.size() - i );
+                        writer.record(
+                            std::chrono::microseconds{ i * 10 }, view_n( stream.data() + i, n ) );
+                }
+                writer.flush();
+                EXPECT_TRUE( writer.good() );
+        }
+
+        protocol_capture_file file{ path.c_str() };
+        ASSERT_TRUE( file.is_open() );
+
+        for ( protocol_replay_timing_enum timing :
+              { PROTOCOL_REPLAY_MAX_THROUGHPUT, PROTOCOL_REPLAY_ORIGINAL_TIMING } ) {
+                auto opt_reader = file.reader();
+                ASSERT_TRUE( opt_reader );
+
+                std::vector< uint32_t > ids;
+                protocol_replay_report  rep = protocol_capture_replay< packet >(
+                    *opt_reader, timing, [&]( const std::tuple< uint32_t, uint8_t >& val ) {
+                            ids.push_back( std::get< 0 >( val ) );
+                    } );
+
+                EXPECT_EQ( ids, ( std::vector< uint32_t >{ 0, 1, 2, 4, 5, 6, 7, 8, 9 } ) );
+                EXPECT_EQ( rep.chunks, ( stream.size() + 6 ) / 7 );
+                EXPECT_EQ( rep.messages, 9u );
+                EXPECT_EQ( rep.stats.bytes_loaded, stream.size() );
+                EXPECT_EQ( rep.stats.frames, 9u );
+                EXPECT_EQ( rep.stats.checksum_failures, 1u );
+                EXPECT_FALSE( rep.truncated );
+                if ( timing == PROTOCOL_REPLAY_ORIGINAL_TIMING ) {
+                        // last chunk was captured at this time
+                        auto last = std::chrono::microseconds{ ( stream.size() - 1 ) / 7 * 70 };
+                        EXPECT_GE( rep.elapsed, last );
+                }
+        }
+}
+
+TEST( protocol_capture, reader )
+{
+        std::vector< uint8_t > data{ 0x00 };
+        EXPECT_FALSE( protocol_capture_reader::make( view_n( data.data(), data.size() ) ) );
+
+        data.assign( protocol_capture_magic.begin(), protocol_capture_magic.end() );
+        // timestamp 0x0102, 3 bytes, only 2 of them present
+        data.insert( data.end(), { 0x02, 0x01, 0, 0, 0, 0, 0, 0, 0x03, 0, 0, 0, 0xaa, 0xbb } );
+
+        auto opt_reader = protocol_capture_reader::make( view_n( data.data(), data.size() ) );
+        ASSERT_TRUE( opt_reader );
+        EXPECT_FALSE( opt_reader->next() );
+        EXPECT_TRUE( opt_reader->truncated() );
+
+        data.push_back( 0xcc );
+        opt_reader = protocol_capture_reader::make( view_n( data.data(), data.size() ) );
+        ASSERT_TRUE( opt_reader );
+        auto opt_chunk = opt_reader->next();
+        ASSERT_TRUE( opt_chunk );
+        EXPECT_EQ( opt_chunk->timestamp, std::chrono::nanoseconds{ 0x0102 } );
+        EXPECT_EQ( opt_chunk->data.size(), 3u );
+        EXPECT_EQ( opt_chunk->data[2], 0xcc );
+        EXPECT_FALSE( opt_reader->next() );
+        EXPECT_FALSE( opt_reader->truncated() );
+}
+
+TEST( protocol_capture, failed_write )
+{
+        std::array< uint8_t, 3 > data{ 1, 2, 3 };
+
+        // all writes to /dev/full fail once the buffered bytes reach the device
+        protocol_capture_writer full{ "/dev/full" };
+        ASSERT_TRUE( full.is_open() );
+        full.record( std::chrono::nanoseconds{ 0 }, view_n( data.data(), data.size() ) );
+        full.flush();
+        EXPECT_FALSE( full.good() );
+
+        protocol_capture_writer missing{ "/nonexistent/emlabcpp_capture.bin" };
+        EXPECT_FALSE( missing.is_open() );
+        EXPECT_FALSE( missing.good() );
+        missing.record( view_n( data.data(), data.size() ) );
+        missing.flush();
+        EXPECT_FALSE( missing.good() );
+}
+
+TEST_F( capture_file_test, missing_file )
+{
+        protocol_capture_file file{ path.c_str() };
+        EXPECT_FALSE( file.is_open() );
+        EXPECT_TRUE( file.data().empty() );
+        EXPECT_FALSE( file.reader() );
+}
+
+TEST_F( capture_file_test, empty_file )
+{
+        std::fclose( std::fopen( path.c_str(), "wb" ) );
+
+        protocol_capture_file file{ path.c_str() };
+        EXPECT_FALSE( file.is_open() );
+        EXPECT_TRUE( file.data().empty() );
+        EXPECT_FALSE( file.reader() );
+}
@@ -0,0 +1,121 @@
+#include "emlabcpp/protocol/concurrent_register_map.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+enum concurrent_keys : uint16_t
+{
+        WIDE  = 1,
+        LEFT  = 2,
+        RIGHT = 3,
+        SMALL = 7
+};
+
+using concurrent_map = protocol_register_map<
+    PROTOCOL_BIG_ENDIAN,
+    protocol_reg< WIDE, uint64_t >,
+    protocol_reg< LEFT, uint32_t >,
+    protocol_reg< RIGHT, uint32_t >,
+    protocol_reg< SMALL, bounded< uint8_t, 2, 4 > > >;
+
+using shared_map = protocol_concurrent_register_map< concurrent_map >;
+
+// Both halves of the value are the same, so torn read can be detected
+constexpr uint64_t wide_value( uint32_t i )
+{
+        return ( static_cast< uint64_t >( i ) << 32 ) | i;
+}
+
+}  // namespace
+
+TEST( protocol_concurrent_map, access )
+{
+        concurrent_map init;
+        init.set_val< LEFT >( 42 );
+        shared_map m{ init };
+
+        EXPECT_EQ( m.get_val< LEFT >(), 42u );
+        EXPECT_EQ( m.get_val< WIDE >(), 0u );
+
+        m.set_val< WIDE >( wide_value( 7 ) );
+        m.set_val< SMALL >( bounded< uint8_t, 2, 4 >::get< 3 >() );
+        EXPECT_EQ( m.get_val< WIDE >(), wide_value( 7 ) );
+        EXPECT_EQ( m.get_val< SMALL >(), ( bounded< uint8_t, 2, 4 >::get< 3 >() ) );
+
+        concurrent_map snap = m.snapshot();
+        EXPECT_EQ( snap.get_val< WIDE >(), wide_value( 7 ) );
+        EXPECT_EQ( snap.get_val< LEFT >(), 42u );
+        EXPECT_EQ( snap.get_val< RIGHT >(), 0u );
+
+        snap.set_val< RIGHT >( 5 );
+        m.store( snap );
+        EXPECT_EQ( m.get_val< RIGHT >(), 5u );
+        EXPECT_EQ( m.get_val< LEFT >(), 42u );
+}
+
+// One writer changes the wide register on its own and the pair of registers always together,
+// readers check that they never see torn value or snapshot with only one of the pair changed.
+TEST( protocol_concurrent_map, stress )
+{
+        static constexpr uint32_t    iterations = 200000;
+        static constexpr std::size_t readers    = 3;
+
+        shared_map              m;
+        std::atomic< bool >     done{ false };
+        std::atomic< bool >     failed{ false };
+        std::vector< uint32_t > snapshots( readers, 0 );
+
+        std::vector< std::thread > threads;
+        for ( std::size_t r = 0; r < readers; r++ ) {
+                threads.emplace_back( [&, r] {
+                        uint32_t last_left = 0;
+                        do {
+                                uint64_t wide = m.get_val< WIDE >();
+                                if ( ( wide >> 32 ) != ( wide & 0xffffffff ) ) {
+                                        failed = true;
+                                }
+                                uint32_t left = m.get_val< LEFT >();
+                                if ( left < last_left ) {
+                                        failed = true;
+                                }
+                                last_left = left;
+
+                                concurrent_map snap = m.snapshot();
+                                if ( snap.get_val< LEFT >() != snap.get_val< RIGHT >() ) {
+                                        failed = true;
+                                }
+                                wide = snap.get_val< WIDE >();
+                                if ( ( wide >> 32 ) != ( wide & 0xffffffff ) ) {
+                                        failed = true;
+                                }
+                                snapshots[r] += 1;
+                        } while ( !done.load() );
+                } );
+        }
+
+        concurrent_map local;
+        for ( uint32_t i = 1; i <= iterations; i++ ) {
+                m.set_val< WIDE >( wide_value( i ) );
+                local.set_val< LEFT >( i );
+                local.set_val< RIGHT >( i );
+                local.set_val< WIDE >( wide_value( i ) );
+                m.store( local );
+        }
+        done = true;
+        for ( std::thread& t : threads ) {
+                t.join();
+        }
+
+        EXPECT_FALSE( failed.load() );
+        EXPECT_EQ( m.get_val< LEFT >(), iterations );
+        EXPECT_EQ( m.snapshot().get_val< RIGHT >(), iterations );
+        for ( uint32_t count : snapshots ) {
+                EXPECT_GT( count, 0u );
+        }
+}
@@ -1,5 +1,7 @@
 #include "emlabcpp/iterators/convert.h"
+#include "emlabcpp/physical_quantity.h"
 #include "emlabcpp/protocol/def.h"
+#include "emlabcpp/protocol/iterator_serializer.h"
 #include "emlabcpp/protocol/streams.h"
 #include "util.h"
 
@@ -39,6 +41,11 @@ struct valid_test_case : protocol_test_fixture
                     << "serialized : " << serialized << "\n"
                     << "expected   : " << convert_view< int >( expected_buffer ) << "\n";
 
+                std::vector< uint8_t > out;
+                protocol_iterator_serializer< T, endianess >::serialize(
+                    std::back_inserter( out ), val );
+                EXPECT_EQ( out, expected_buffer );
+
                 auto [pused, res] = pitem::deserialize(
                     *bounded_view< const uint8_t*, typename pitem::size_type >::make(
                         view_n( buffer.begin(), *used ) ) );
@@ -134,6 +141,31 @@ const variable_size_type VARIABLE_VAL_1{ std::array< uint8_t, 3 >{ 1, 2, 3 } };
 const variable_size_type VARIABLE_VAL_2{ std::array< uint8_t, 7 >{ 1, 2, 3, 4, 5, 6, 7 } };
 const variable_size_type VARIABLE_VAL_3{ std::array< uint8_t, 0 >{} };
 
+const std::array< uint8_t, 5 > BYTES_VAL{ 1, 2, 3, 4, 5 };
+const std::array< uint8_t, 6 > LAZY_VAL{ 0, 2, 0, 1, 2, 154 };
+
+// Arrays of scalars are serialized in bulk at runtime, but can still be used in constant expression
+template < protocol_endianess_enum Endianess, typename T, std::size_t N >
+constexpr bool constexpr_array_round_trip( const std::array< T, N >& val )
+{
+        using def = protocol_def< std::array< T, N >, Endianess >;
+
+        std::array< uint8_t, def::max_size > buffer{};
+        def::serialize_at( std::span< uint8_t, def::max_size >{ buffer }, val );
+        auto [used, res] = def::deserialize(
+            bounded_view< const uint8_t*, typename def::size_type >::template make_n<
+                def::max_size >( buffer.data() ) );
+        return used == def::max_size && std::holds_alternative< std::array< T, N > >( res ) &&
+               std::get< 0 >( res ) == val;
+}
+
+static_assert( constexpr_array_round_trip< PROTOCOL_BIG_ENDIAN >(
+    std::array< uint16_t, 3 >{ 1, 0x0203, 0xffff } ) );
+static_assert( constexpr_array_round_trip< PROTOCOL_LITTLE_ENDIAN >(
+    std::array< int32_t, 4 >{ -1, 0, 42, 0x01020304 } ) );
+static_assert( constexpr_array_round_trip< PROTOCOL_LITTLE_ENDIAN >(
+    std::array< uint8_t, 5 >{ 1, 2, 3, 4, 5 } ) );
+
 int main( int argc, char** argv )
 {
         testing::InitGoogleTest( &argc, argv );
@@ -147,11 +179,32 @@ int main( int argc, char** argv )
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >( uint16_t{ 666 }, { 154, 2 } ),
             make_valid_test_case< PROTOCOL_BIG_ENDIAN >( uint16_t{ 666 }, { 2, 154 } ),
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >( int32_t{ -1 }, { 255, 255, 255, 255 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                uint32_t{ 0x01020304 }, { 0x04, 0x03, 0x02, 0x01 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                uint32_t{ 0x01020304 }, { 0x01, 0x02, 0x03, 0x04 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                uint64_t{ 0x0102030405060708 }, { 8, 7, 6, 5, 4, 3, 2, 1 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                int64_t{ -666 }, { 255, 255, 255, 255, 255, 255, 253, 102 } ),
+            // floating point
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >( 1.f, { 0x00, 0x00, 0x80, 0x3f } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >( 1.f, { 0x3f, 0x80, 0x00, 0x00 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >( -2., { 0xc0, 0, 0, 0, 0, 0, 0, 0 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >( -2., { 0, 0, 0, 0, 0, 0, 0, 0xc0 } ),
             // std::array
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
                 std::array< int16_t, 3 >{ -1, 1, 666 }, { 255, 255, 1, 0, 154, 2 } ),
             make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
                 std::array< int16_t, 3 >{ -1, 1, 666 }, { 255, 255, 0, 1, 2, 154 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                std::array< uint8_t, 3 >{ 1, 2, 3 }, { 1, 2, 3 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                std::array< uint32_t, 2 >{ 0x01020304, 42 }, { 1, 2, 3, 4, 0, 0, 0, 42 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                std::array< uint32_t, 2 >{ 0x01020304, 42 }, { 4, 3, 2, 1, 42, 0, 0, 0 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                std::array< float, 2 >{ 1.f, -2.f }, { 0x3f, 0x80, 0, 0, 0xc0, 0, 0, 0 } ),
             // std::tuple
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
                 std::tuple< uint8_t, int16_t, int8_t >{ 1u, 666u, -3u }, { 1, 154, 2, 253 } ),
@@ -164,6 +217,9 @@ int main( int argc, char** argv )
                 std::variant< uint8_t, int16_t, uint16_t >{ int16_t{ -3 } }, { 1, 255, 253 } ),
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
                 std::variant< uint8_t, int16_t, uint16_t >{ uint8_t{ 42 } }, { 0, 42 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                std::variant< uint8_t, uint8_t >{ std::in_place_index< 1 >, uint8_t{ 42 } },
+                { 1, 42 } ),
             make_invalid_test_case< std::variant< uint8_t, int16_t, uint16_t > >(
                 { 3, 0, 0 }, protocol_error_record{ UNDEFVAR_ERR, 0 } ),
             make_invalid_test_case< std::variant< uint8_t, int16_t, uint16_t > >(
@@ -186,6 +242,24 @@ int main( int argc, char** argv )
             make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
                 *protocol_sizeless_message< 8 >::make( std::vector{ 1, 2, 3, 4, 5 } ),
                 { 1, 2, 3, 4, 5 } ),
+            // protocol_bytes_view
+            make_specific_valid_test_case< PROTOCOL_LITTLE_ENDIAN, protocol_bytes_view< 8 > >(
+                view{ BYTES_VAL }, { 1, 2, 3, 4, 5 } ),
+            make_specific_valid_test_case< PROTOCOL_BIG_ENDIAN, protocol_bytes_view< 8 > >(
+                view< const uint8_t* >{}, {} ),
+            // protocol_array_view
+            make_specific_valid_test_case<
+                PROTOCOL_BIG_ENDIAN,
+                protocol_array_view< uint16_t, 4 > >(
+                protocol_lazy_array< uint16_t >{ view{ LAZY_VAL }, PROTOCOL_BIG_ENDIAN },
+                { 0, 3, 0, 2, 0, 1, 2, 154 } ),
+            make_specific_valid_test_case<
+                PROTOCOL_LITTLE_ENDIAN,
+                protocol_array_view< uint16_t, 4 > >(
+                protocol_lazy_array< uint16_t >{ view{ LAZY_VAL }, PROTOCOL_BIG_ENDIAN },
+                { 3, 0, 2, 0, 1, 0, 154, 2 } ),
+            make_invalid_test_case< protocol_array_view< int16_t, 9 > >(
+                { 4, 0, 0, 0, 0, 0, 0 }, protocol_error_record{ SIZE_ERR, 6 } ),
             // protocol_offset
             make_specific_valid_test_case< PROTOCOL_LITTLE_ENDIAN, protocol_offset< uint16_t, 0 > >(
                 666u, { 154, 2 } ),
@@ -200,6 +274,10 @@ int main( int argc, char** argv )
                 tagged_quantity< struct offtag, uint16_t >{ 666u }, { 154, 2 } ),
             make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
                 tagged_quantity< struct offtag, uint16_t >{ 666u }, { 2, 154 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                velocity{ 1.5f }, { 0x3f, 0xc0, 0x00, 0x00 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                angle{ -2.f }, { 0x00, 0x00, 0x00, 0xc0 } ),
             // bounded
             make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
                 bounded< uint16_t, 0, 1024u >::get< 666u >(), { 154, 2 } ),
@@ -262,6 +340,12 @@ int main( int argc, char** argv )
                 static_vector< variable_size_type, 4 >( std::array< variable_size_type, 3 >{
                     VARIABLE_VAL_1, VARIABLE_VAL_2, VARIABLE_VAL_3 } ),
                 { 3, 0, 3, 0, 1, 2, 3, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 0 } ),
+            make_valid_test_case< PROTOCOL_BIG_ENDIAN >(
+                static_vector< uint32_t, 4 >( std::array< uint32_t, 2 >{ 0x01020304, 42 } ),
+                { 0, 2, 1, 2, 3, 4, 0, 0, 0, 42 } ),
+            make_valid_test_case< PROTOCOL_LITTLE_ENDIAN >(
+                static_vector< uint32_t, 4 >( std::array< uint32_t, 2 >{ 0x01020304, 42 } ),
+                { 2, 0, 4, 3, 2, 1, 42, 0, 0, 0 } ),
             make_invalid_test_case< static_vector< int16_t, 9 > >(
                 { 1, 0 }, protocol_error_record{ SIZE_ERR, 2 } ),
             make_invalid_test_case< static_vector< int16_t, 9 > >(
@@ -0,0 +1,179 @@
+#include "emlabcpp/protocol/command_group.h"
+#include "emlabcpp/protocol/dispatcher.h"
+#include "emlabcpp/protocol/handler.h"
+#include "emlabcpp/protocol/streams.h"
+
+#include <gtest/gtest.h>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+enum dispatch_ids : uint16_t
+{
+        DA = 2,
+        DB = 3,
+        DC = 7,
+        DD = 8,
+        DE = 900
+};
+
+struct dispatch_group
+  : protocol_command_group< PROTOCOL_LITTLE_ENDIAN >::with_commands<
+        protocol_command< DA >,
+        protocol_command< DB >::with_args< uint32_t, int16_t >,
+        protocol_command< DC >::with_args< std::array< uint16_t, 3 >, bounded< uint8_t, 1, 5 > >,
+        protocol_command< DD >::with_args< uint8_t, protocol_sizeless_message< 8 > >,
+        protocol_command< DE >::with_args< std::tuple< uint8_t, uint32_t > > >
+{
+};
+
+using group_value = dispatch_group::value_type;
+
+// Rebuilds the value of the group from the arguments, so it can be compared with the value that
+// was serialized
+struct recorder
+{
+        std::optional< group_value > last;
+        std::size_t                  calls = 0;
+
+        template < auto ID, typename... Args >
+        void operator()( tag< ID >, Args... args )
+        {
+                last = dispatch_group::make_val< ID >( args... );
+                calls += 1;
+        }
+};
+
+// Handles one command specifically and ignores the others
+struct only_db
+{
+        uint32_t a = 0;
+
+        void operator()( tag< DB >, uint32_t val, int16_t )
+        {
+                a = val;
+        }
+
+        void operator()( auto, auto... )
+        {
+        }
+};
+
+using dispatcher = protocol_dispatcher< dispatch_group, recorder >;
+using handler    = protocol_handler< dispatch_group >;
+
+}  // namespace
+
+TEST( protocol_dispatcher, dispatch )
+{
+        std::vector< group_value > vals = {
+            dispatch_group::make_val< DA >(),
+            dispatch_group::make_val< DB >( 0xdeadbeefu, int16_t{ -3 } ),
+            dispatch_group::make_val< DC >(
+                std::array< uint16_t, 3 >{ 1, 2, 3 }, bounded< uint8_t, 1, 5 >::get< 4 >() ),
+            dispatch_group::make_val< DD >(
+                uint8_t{ 42 }, *protocol_sizeless_message< 8 >::make( std::array{ 1, 2, 3 } ) ),
+            dispatch_group::make_val< DE >( std::tuple{ uint8_t{ 1 }, 666u } ) };
+
+        for ( const group_value& val : vals ) {
+                auto     msg = handler::serialize( val );
+                recorder rec;
+                EXPECT_FALSE( dispatcher::dispatch( msg, rec ) );
+                EXPECT_EQ( rec.calls, 1u );
+                ASSERT_TRUE( rec.last );
+                EXPECT_EQ( *rec.last, val );
+        }
+}
+
+TEST( protocol_dispatcher, overloads )
+{
+        only_db h;
+        auto    msg = handler::serialize( dispatch_group::make_val< DB >( 42u, int16_t{ 0 } ) );
+        EXPECT_FALSE( ( protocol_dispatcher< dispatch_group, only_db >::dispatch( msg, h ) ) );
+        EXPECT_EQ( h.a, 42u );
+}
+
+TEST( protocol_dispatcher, errors )
+{
+        recorder rec;
+
+        std::vector< uint8_t > empty;
+        auto size_err = dispatcher::dispatch( view_n( empty.data(), empty.size() ), rec );
+        ASSERT_TRUE( size_err );
+        EXPECT_EQ( size_err->mark, SIZE_ERR );
+
+        std::vector< uint8_t > unknown = { 5, 0 };
+        auto group_err = dispatcher::dispatch( view_n( unknown.data(), unknown.size() ), rec );
+        ASSERT_TRUE( group_err );
+        EXPECT_EQ( group_err->mark, GROUP_ERR );
+
+        // truncated second argument, the message does not match any command
+        auto                   msg = handler::serialize( dispatch_group::make_val< DB >(
+            0u, int16_t{ 1 } ) );
+        std::vector< uint8_t > truncated( msg.begin(), msg.end() - 1 );
+        auto                   trunc_err =
+            dispatcher::dispatch( view_n( truncated.data(), truncated.size() ), rec );
+        ASSERT_TRUE( trunc_err );
+        EXPECT_EQ( trunc_err->mark, GROUP_ERR );
+        EXPECT_EQ( trunc_err->offset, 0u );
+
+        // value out of the bounds of the argument
+        std::vector< uint8_t > bounds = { DC, 0, 1, 0, 2, 0, 3, 0, 9 };
+        auto bounds_err = dispatcher::dispatch( view_n( bounds.data(), bounds.size() ), rec );
+        ASSERT_TRUE( bounds_err );
+        EXPECT_EQ( bounds_err->mark, BOUNDS_ERR );
+
+        EXPECT_EQ( rec.calls, 0u );
+}
+
+// Dispatch reports the same errors as the extraction of the group for each prefix of valid
+// messages and for messages with corrupted bytes
+TEST( protocol_dispatcher, errors_match_extract )
+{
+        std::vector< group_value > vals = {
+            dispatch_group::make_val< DA >(),
+            dispatch_group::make_val< DB >( 0xdeadbeefu, int16_t{ -3 } ),
+            dispatch_group::make_val< DC >(
+                std::array< uint16_t, 3 >{ 1, 2, 3 }, bounded< uint8_t, 1, 5 >::get< 4 >() ),
+            dispatch_group::make_val< DD >(
+                uint8_t{ 42 }, *protocol_sizeless_message< 8 >::make( std::array{ 1, 2, 3 } ) ),
+            dispatch_group::make_val< DE >( std::tuple{ uint8_t{ 1 }, 666u } ) };
+
+        auto check = [&]( const std::vector< uint8_t >& data ) {
+                recorder rec;
+                auto     err = dispatcher::dispatch( view_n( data.data(), data.size() ), rec );
+                handler::extract( view_n( data.data(), data.size() ) )
+                    .match(
+                        [&]( const group_value& val ) {
+                                EXPECT_FALSE( err ) << *err;
+                                ASSERT_TRUE( rec.last );
+                                EXPECT_EQ( *rec.last, val );
+                        },
+                        [&]( const protocol_error_record& rec_err ) {
+                                ASSERT_TRUE( err ) << rec_err;
+                                EXPECT_EQ( err->mark, rec_err.mark );
+                                EXPECT_EQ( err->offset, rec_err.offset );
+                                EXPECT_EQ( rec.calls, 0u );
+                        } );
+        };
+
+        for ( const group_value& val : vals ) {
+                auto                   msg = handler::serialize( val );
+                std::vector< uint8_t > data( msg.begin(), msg.end() );
+                for ( auto end = data.begin(); end != data.end(); ++end ) {
+                        check( { data.begin(), end } );
+                }
+                check( data );
+                for ( std::size_t i = 0; i < data.size(); i++ ) {
+                        for ( uint8_t b : { uint8_t{ 0x00 }, uint8_t{ 0x09 }, uint8_t{ 0xff } } ) {
+                                std::vector< uint8_t > corrupted = data;
+                                corrupted[i]                     = b;
+                                check( corrupted );
+                        }
+                }
+                data.push_back( 0x42 );
+                check( data );
+        }
+}
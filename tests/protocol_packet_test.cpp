@@ -61,3 +61,171 @@ TEST( Packet, seq )
                         EXPECT_EQ( newmsg, msg );
                 } );
 }
+
+struct protocol_packet_crc_test_def : protocol_packet_crc< crc16_ccitt >
+{
+        static constexpr protocol_endianess_enum  endianess = PROTOCOL_BIG_ENDIAN;
+        static constexpr std::array< uint8_t, 4 > prefix    = { 0x91, 0x19, 0x91, 0x19 };
+        using size_type                                     = uint16_t;
+};
+
+using crc_packet  = protocol_packet< protocol_packet_crc_test_def, payload >;
+using crc_handler = protocol_packet_handler< crc_packet >;
+
+template < typename Handler, typename View >
+concept extracts_sequenced = requires( View v )
+{
+        Handler::extract_sequenced( v );
+};
+
+TEST( Packet, crc )
+{
+        std::tuple< uint32_t, uint8_t, uint8_t > val{ 0x43434343, 0x8, 0x16 };
+        typename crc_packet::message_type        msg = crc_handler::serialize( val );
+
+        uint16_t chcksm = crc16_ccitt::compute( view_n( msg.begin(), msg.size() - 2 ) );
+        EXPECT_EQ( msg[msg.size() - 2], chcksm >> 8 );
+        EXPECT_EQ( msg[msg.size() - 1], chcksm & 0xff );
+
+        crc_handler::extract( msg ).match(
+            [&]( std::tuple< uint32_t, uint8_t, uint8_t > pack ) {
+                    EXPECT_EQ( pack, val );
+            },
+            [&]( protocol_error_record e ) {
+                    FAIL() << e;
+            } );
+
+        // corrupted payload is detected by the checksum
+        msg[8] ^= 0x01;
+        EXPECT_FALSE( crc_handler::extract( msg ).is_left() );
+}
+
+TEST( Packet, serialize_into )
+{
+        std::tuple< uint32_t, uint8_t, uint8_t > val{ 0x43434343, 0x8, 0x16 };
+        typename crc_packet::message_type        msg = crc_handler::serialize( val );
+
+        std::array< uint8_t, crc_handler::max_size + 4 > buffer{};
+        std::optional< std::size_t > used = crc_handler::serialize_into( buffer, val );
+        ASSERT_TRUE( used );
+        EXPECT_EQ( *used, msg.size() );
+        EXPECT_TRUE( std::equal( msg.begin(), msg.end(), buffer.begin() ) );
+
+        // buffer has to have space for packet of maximal size
+        std::array< uint8_t, crc_handler::max_size - 1 > small{};
+        EXPECT_FALSE( crc_handler::serialize_into( small, val ) );
+}
+
+// The checksum is updated segment by segment, also for payloads of variable size
+TEST( Packet, crc_variable_payload )
+{
+        using var_payload =
+            protocol_tuple< PROTOCOL_BIG_ENDIAN, uint8_t, static_vector< uint8_t, 8 > >;
+        using var_packet  = protocol_packet< protocol_packet_crc_test_def, var_payload >;
+        using var_handler = protocol_packet_handler< var_packet >;
+
+        for ( std::size_t n : { 0u, 3u, 8u } ) {
+                std::tuple< uint8_t, static_vector< uint8_t, 8 > > val{ 0x42, {} };
+                for ( std::size_t i = 0; i < n; i++ ) {
+                        std::get< 1 >( val ).push_back( static_cast< uint8_t >( i ) );
+                }
+                typename var_packet::message_type msg = var_handler::serialize( val );
+
+                uint16_t chcksm = crc16_ccitt::compute( view_n( msg.begin(), msg.size() - 2 ) );
+                EXPECT_EQ( msg[msg.size() - 2], chcksm >> 8 );
+                EXPECT_EQ( msg[msg.size() - 1], chcksm & 0xff );
+                EXPECT_TRUE( var_handler::extract( msg ).is_left() );
+        }
+}
+
+TEST( Packet, crc_seq )
+{
+        using seq = typename crc_packet::view_sequencer;
+        static_assert( seq::checksum );
+        static_assert( !packet::sequencer::checksum );
+        // only views verified by the sequencer are extracted without checking the checksum
+        static_assert( std::same_as< seq::view_type, protocol_verified_view > );
+        static_assert( extracts_sequenced< crc_handler, protocol_verified_view > );
+        static_assert( !extracts_sequenced< crc_handler, view< const uint8_t* > > );
+
+        std::tuple< uint32_t, uint8_t, uint8_t > val{ 0x43434343, 0x8, 0x16 };
+        typename crc_packet::message_type        msg = crc_handler::serialize( val );
+        typename crc_packet::message_type        bad = msg;
+        bad[8] ^= 0x01;
+
+        // message with invalid checksum is discarded, the valid message after it is found
+        std::vector< uint8_t > data;
+        data.insert( data.end(), bad.begin(), bad.end() );
+        data.insert( data.end(), msg.begin(), msg.end() );
+
+        seq                                                   test_seq{};
+        std::vector< std::tuple< uint32_t, uint8_t, uint8_t > > vals;
+
+        // bytes arrive one by one, the checksum is computed along the way
+        for ( uint8_t b : data ) {
+                test_seq.load_view( view_n( &b, 1 ), [&]( protocol_verified_view mview ) {
+                        crc_handler::extract_sequenced( mview ).match(
+                            [&]( std::tuple< uint32_t, uint8_t, uint8_t > pack ) {
+                                    vals.push_back( pack );
+                            },
+                            [&]( protocol_error_record e ) {
+                                    FAIL() << e;
+                            } );
+                } );
+        }
+
+        ASSERT_EQ( vals.size(), 1u );
+        EXPECT_EQ( vals[0], val );
+
+        // same with the circular buffer, which wraps around during the stream
+        typename crc_packet::sequencer circ_seq{};
+        std::size_t                    count = 0;
+        for ( std::size_t i = 0; i < 5; i++ ) {
+                for ( std::size_t j = 0; j < data.size(); j += 5 ) {
+                        std::size_t n = std::min< std::size_t >( 5, data.size() - j );
+                        circ_seq.load_data( view_n( data.data() + j, n ), [&]( const auto& m ) {
+                                EXPECT_EQ( m, msg );
+                                count += 1;
+                        } );
+                }
+        }
+        EXPECT_EQ( count, 5u );
+}
+
+TEST( Packet, stats )
+{
+        using seq = typename crc_packet::stats_view_sequencer< protocol_stats<> >;
+
+        std::tuple< uint32_t, uint8_t, uint8_t > val{ 0x43434343, 0x8, 0x16 };
+        typename crc_packet::message_type        msg = crc_handler::serialize( val );
+        typename crc_packet::message_type        bad = msg;
+        bad[8] ^= 0x01;
+
+        // valid packet, packet with broken checksum and packet with broken size of payload
+        std::vector< uint8_t > data;
+        data.insert( data.end(), msg.begin(), msg.end() );
+        data.insert( data.end(), bad.begin(), bad.end() );
+        typename crc_packet::message_type short_msg = msg;
+        short_msg[5]                                  = 0x07;
+        uint16_t chcksm = crc16_ccitt::compute( view_n( short_msg.begin(), 11 ) );
+        short_msg[11]   = static_cast< uint8_t >( chcksm >> 8 );
+        short_msg[12]   = static_cast< uint8_t >( chcksm & 0xff );
+        data.insert( data.end(), short_msg.begin(), short_msg.begin() + 13 );
+
+        seq test_seq{};
+        test_seq.load_view( view{ data }, [&]( protocol_verified_view mview ) {
+                std::ignore = crc_handler::extract_sequenced( mview, test_seq.stats() );
+        } );
+
+        auto snap = test_seq.stats().snapshot();
+        EXPECT_EQ( snap.frames, 2u );
+        EXPECT_EQ( snap.checksum_failures, 1u );
+        EXPECT_EQ( snap.bytes_loaded, data.size() );
+        EXPECT_EQ( snap.error_count( LOWSIZE_ERR ) + snap.error_count( SIZE_ERR ), 1u );
+
+        // checksum checked by the handler is counted as well
+        protocol_stats<> handler_stats;
+        auto             res = crc_handler::extract( bad, handler_stats );
+        EXPECT_FALSE( res.is_left() );
+        EXPECT_EQ( handler_stats.snapshot().checksum_failures, 1u );
+}
@@ -0,0 +1,305 @@
+#include "emlabcpp/experimental/mapped_file.h"
+#include "emlabcpp/protocol/register_image.h"
+#include "emlabcpp/protocol/register_map.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace emlabcpp;
+
+namespace
+{
+
+enum image_keys : uint16_t
+{
+        SPEED  = 3,
+        LIMIT  = 5,
+        MODE   = 6,
+        OFFSET = 20
+};
+
+using image_map = protocol_register_map<
+    PROTOCOL_LITTLE_ENDIAN,
+    protocol_reg< SPEED, uint32_t >,
+    protocol_reg< LIMIT, uint16_t >,
+    protocol_reg< MODE, bounded< uint8_t, 1, 3 > >,
+    protocol_reg< OFFSET, int64_t > >;
+
+using image = protocol_register_image< image_map >;
+
+using other_map = protocol_register_map<
+    PROTOCOL_LITTLE_ENDIAN,
+    protocol_reg< SPEED, uint32_t >,
+    protocol_reg< LIMIT, uint32_t >,
+    protocol_reg< MODE, bounded< uint8_t, 1, 3 > >,
+    protocol_reg< OFFSET, int64_t > >;
+
+// same layout as image_map with different types of registers
+using float_map = protocol_register_map<
+    PROTOCOL_LITTLE_ENDIAN,
+    protocol_reg< SPEED, float >,
+    protocol_reg< LIMIT, uint16_t >,
+    protocol_reg< MODE, bounded< uint8_t, 1, 3 > >,
+    protocol_reg< OFFSET, int64_t > >;
+
+using unbounded_map = protocol_register_map<
+    PROTOCOL_LITTLE_ENDIAN,
+    protocol_reg< SPEED, uint32_t >,
+    protocol_reg< LIMIT, uint16_t >,
+    protocol_reg< MODE, uint8_t >,
+    protocol_reg< OFFSET, int64_t > >;
+
+image_map make_map()
+{
+        image_map m;
+        m.set_val< SPEED >( 1200 );
+        m.set_val< LIMIT >( 42 );
+        m.set_val< MODE >( bounded< uint8_t, 1, 3 >::get< 2 >() );
+        m.set_val< OFFSET >( -7 );
+        return m;
+}
+
+void expect_same( const image_map& lh, const image_map& rh )
+{
+        EXPECT_EQ( lh.get_val< SPEED >(), rh.get_val< SPEED >() );
+        EXPECT_EQ( lh.get_val< LIMIT >(), rh.get_val< LIMIT >() );
+        EXPECT_EQ( lh.get_val< MODE >(), rh.get_val< MODE >() );
+        EXPECT_EQ( lh.get_val< OFFSET >(), rh.get_val< OFFSET >() );
+}
+
+}  // namespace
+
+TEST( protocol_register_image, round_trip )
+{
+        static_assert( image::schema_hash != protocol_register_image< other_map >::schema_hash );
+        EXPECT_EQ( image::header_size, 4 + 1 + 4 + 2 + 4 * 2 + 4 );
+        EXPECT_EQ( image::max_size, image::header_size + 4 + 2 + 1 + 8 );
+
+        image_map source = make_map();
+        auto      msg    = image::serialize( source );
+        EXPECT_EQ( msg.size(), image::max_size );
+        // magic and version are little endian as the map
+        EXPECT_EQ( msg[0], 0x49 );
+        EXPECT_EQ( msg[4], image::version );
+
+        image::extract( msg ).match(
+            [&]( const image_map& m ) {
+                    expect_same( m, source );
+            },
+            [&]( const protocol_error_record& ) {
+                    FAIL();
+            } );
+
+        std::array< uint8_t, image::max_size - 1 > small;
+        EXPECT_FALSE( image::serialize_into( small, source ) );
+}
+
+TEST( protocol_register_image, invalid )
+{
+        auto msg = image::serialize( make_map() );
+
+        auto expect_error = [&]( std::vector< uint8_t > data, std::size_t offset ) {
+                image_map m;
+                image::insert( m, view_n( data.data(), data.size() ) )
+                    .match(
+                        [&]( std::size_t ) {
+                                FAIL();
+                        },
+                        [&]( const protocol_error_record& rec ) {
+                                EXPECT_EQ( rec.offset, offset );
+                        } );
+        };
+        std::vector< uint8_t > data( msg.begin(), msg.end() );
+
+        auto bad_magic = data;
+        bad_magic[1]   = 0;
+        expect_error( bad_magic, 0 );
+
+        auto bad_hash = data;
+        bad_hash[6] ^= 1;
+        expect_error( bad_hash, 5 );
+
+        auto bad_key = data;
+        bad_key[4 + 1 + 4 + 2 + 2] = 4;
+        expect_error( bad_key, 4 + 1 + 4 + 2 + 2 );
+
+        auto truncated = data;
+        truncated.pop_back();
+        expect_error( truncated, truncated.size() );
+
+        expect_error( { data.begin(), data.begin() + 10 }, 10 );
+
+        auto bad_value                        = data;
+        bad_value[image::header_size + 4 + 2] = 7;
+        expect_error( bad_value, image::header_size + 4 + 2 );
+
+        auto other = protocol_register_image< other_map >::serialize( other_map{} );
+        expect_error( { other.begin(), other.end() }, 5 );
+}
+
+TEST( protocol_register_image, schema )
+{
+        static_assert( protocol_schema< uint32_t >::hash != protocol_schema< float >::hash );
+        static_assert( protocol_schema< uint32_t >::hash != protocol_schema< int32_t >::hash );
+        static_assert(
+            protocol_schema< uint8_t >::hash !=
+            protocol_schema< bounded< uint8_t, 0, 3 > >::hash );
+        static_assert(
+            protocol_schema< bounded< uint8_t, 0, 3 > >::hash !=
+            protocol_schema< bounded< uint8_t, 0, 4 > >::hash );
+        static_assert(
+            protocol_schema< std::tuple< uint8_t, uint16_t > >::hash !=
+            protocol_schema< std::tuple< uint16_t, uint8_t > >::hash );
+
+        static_assert( image::schema_hash != protocol_register_image< float_map >::schema_hash );
+        static_assert(
+            image::schema_hash != protocol_register_image< unbounded_map >::schema_hash );
+
+        // image of map with same sizes but different types is refused at the schema hash
+        auto msg = protocol_register_image< unbounded_map >::serialize( unbounded_map{} );
+        image::extract( msg ).match(
+            [&]( const image_map& ) {
+                    FAIL();
+            },
+            [&]( const protocol_error_record& rec ) {
+                    EXPECT_EQ( rec.mark, BADVAL_ERR );
+                    EXPECT_EQ( rec.offset, 5u );
+            } );
+}
+
+TEST( protocol_register_image, failed_insert )
+{
+        using tail_map = protocol_register_map<
+            PROTOCOL_LITTLE_ENDIAN,
+            protocol_reg< SPEED, uint32_t >,
+            protocol_reg< MODE, bounded< uint8_t, 1, 3 > > >;
+        using tail_image = protocol_register_image< tail_map >;
+
+        tail_map source;
+        source.set_val< SPEED >( 7 );
+        auto                   msg = tail_image::serialize( source );
+        std::vector< uint8_t > data( msg.begin(), msg.end() );
+        // value of the last register is out of its bounds
+        data.back() = 9;
+
+        tail_map m;
+        m.set_val< SPEED >( 1200 );
+        m.set_val< MODE >( bounded< uint8_t, 1, 3 >::get< 3 >() );
+        tail_image::insert( m, view_n( data.data(), data.size() ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL();
+                },
+                [&]( const protocol_error_record& rec ) {
+                        EXPECT_EQ( rec.mark, BOUNDS_ERR );
+                } );
+        EXPECT_EQ( m.get_val< SPEED >(), 1200u );
+        EXPECT_EQ( m.get_val< MODE >(), ( bounded< uint8_t, 1, 3 >::get< 3 >() ) );
+
+        data.back() = 2;
+        tail_image::insert( m, view_n( data.data(), data.size() ) )
+            .match(
+                [&]( std::size_t used ) {
+                        EXPECT_EQ( used, data.size() );
+                },
+                [&]( const protocol_error_record& ) {
+                        FAIL();
+                } );
+        EXPECT_EQ( m.get_val< SPEED >(), 7u );
+        EXPECT_EQ( m.get_val< MODE >(), ( bounded< uint8_t, 1, 3 >::get< 2 >() ) );
+}
+
+TEST( protocol_register_image, mapped_file )
+{
+        std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                     ( "emlabcpp_image_" + std::to_string( getpid() ) + ".bin" );
+
+        std::vector< image_map > maps;
+        for ( uint32_t i = 0; i < 16; i++ ) {
+                image_map m = make_map();
+                m.set_val< SPEED >( i );
+                maps.push_back( m );
+        }
+
+        std::FILE* f = std::fopen( path.c_str(), "wb" );
+        ASSERT_NE( f, nullptr );
+        for ( const image_map& m : maps ) {
+                auto msg = image::serialize( m );
+                std::fwrite( msg.begin(), 1, msg.size(), f );
+        }
+        std::fclose( f );
+
+        {
+                mapped_file file{ path.c_str() };
+                ASSERT_TRUE( file.is_open() );
+
+                view< const uint8_t* > rest = file.data();
+                for ( const image_map& expected : maps ) {
+                        image_map m;
+                        image::insert( m, rest ).match(
+                            [&]( std::size_t used ) {
+                                    rest = view_n( rest.begin() + used, rest.size() - used );
+                            },
+                            [&]( const protocol_error_record& ) {
+                                    FAIL();
+                            } );
+                        expect_same( m, expected );
+                }
+                EXPECT_TRUE( rest.empty() );
+        }
+
+        std::filesystem::remove( path );
+}
+
+// Loading from file that could not be mapped, is empty, or has the last image cut off
+TEST( protocol_register_image, mapped_file_failure )
+{
+        std::filesystem::path path =
+            std::filesystem::temp_directory_path() /
+            ( "emlabcpp_image_fail_" + std::to_string( getpid() ) + ".bin" );
+
+        auto expect_error = [&]( view< const uint8_t* > data, std::size_t offset ) {
+                image_map m = make_map();
+                image::insert( m, data ).match(
+                    [&]( std::size_t ) {
+                            FAIL();
+                    },
+                    [&]( const protocol_error_record& rec ) {
+                            EXPECT_EQ( rec.mark, LOWSIZE_ERR );
+                            EXPECT_EQ( rec.offset, offset );
+                    } );
+                expect_same( m, make_map() );
+        };
+
+        {
+                mapped_file file{ path.c_str() };
+                EXPECT_FALSE( file.is_open() );
+                EXPECT_TRUE( file.data().empty() );
+                expect_error( file.data(), 0 );
+        }
+
+        std::FILE* f = std::fopen( path.c_str(), "wb" );
+        ASSERT_NE( f, nullptr );
+        std::fclose( f );
+        {
+                mapped_file file{ path.c_str() };
+                EXPECT_FALSE( file.is_open() );
+                expect_error( file.data(), 0 );
+        }
+
+        auto msg = image::serialize( make_map() );
+        f        = std::fopen( path.c_str(), "wb" );
+        ASSERT_NE( f, nullptr );
+        std::fwrite( msg.begin(), 1, msg.size() - 1, f );
+        std::fclose( f );
+        {
+                mapped_file file{ path.c_str() };
+                ASSERT_TRUE( file.is_open() );
+                expect_error( file.data(), msg.size() - 1 );
+        }
+
+        std::filesystem::remove( path );
+}
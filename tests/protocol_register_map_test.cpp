@@ -68,6 +68,12 @@ struct valid_test_case : protocol_test_fixture
 
                 auto msg = test_handler::serialize< Key >( stored );
                 EXPECT_EQ( source_msg, msg ) << m;
+
+                std::array< uint8_t, max_size > into_buffer;
+                std::optional< std::size_t >    opt_used =
+                    test_handler::select_into( m, Key, into_buffer );
+                ASSERT_TRUE( opt_used );
+                EXPECT_EQ( *message_type::make( view_n( into_buffer.begin(), *opt_used ) ), msg );
         }
 
         void generate_name( std::ostream& os ) const final
@@ -98,6 +104,235 @@ TEST( protocol_map, runtime_access )
         }
 }
 
+TEST( protocol_map, key_index )
+{
+        // dense keys, looked up directly
+        using dense_index = protocol_key_index< FOO, WOO, TOO, SOO, KOO >;
+        static_assert( dense_index::find( FOO ) == 0 );
+        static_assert( dense_index::find( KOO ) == 4 );
+        EXPECT_EQ( dense_index::find( static_cast< test_keys >( 2 ) ), dense_index::npos );
+        EXPECT_EQ( dense_index::find( static_cast< test_keys >( 0 ) ), dense_index::npos );
+        EXPECT_EQ( dense_index::find( static_cast< test_keys >( 11 ) ), dense_index::npos );
+
+        // sparse keys, found by binary search
+        using sparse_index = protocol_key_index< 9000, 3, 70, -500, 3 >;
+        std::vector< int > keys{ 9000, 3, 70, -500 };
+        for ( auto [i, k] : enumerate( keys ) ) {
+                EXPECT_EQ( sparse_index::find( k ), i );
+        }
+        EXPECT_EQ( sparse_index::find( 4 ), sparse_index::npos );
+        EXPECT_EQ( sparse_index::find( 10000 ), sparse_index::npos );
+        EXPECT_EQ( sparse_index::find( -501 ), sparse_index::npos );
+
+        // signed keys around zero
+        using signed_index = protocol_key_index< int8_t{ -2 }, int8_t{ 1 }, int8_t{ -1 } >;
+        EXPECT_EQ( signed_index::find( -2 ), 0u );
+        EXPECT_EQ( signed_index::find( 1 ), 1u );
+        EXPECT_EQ( signed_index::find( -1 ), 2u );
+        EXPECT_EQ( signed_index::find( 0 ), signed_index::npos );
+        EXPECT_EQ( signed_index::find( 127 ), signed_index::npos );
+
+        // keys spanning whole range of 64-bit type
+        using wide_index = protocol_key_index<
+            std::numeric_limits< uint64_t >::max(),
+            uint64_t{ 0 },
+            uint64_t{ 1 } >;
+        EXPECT_EQ( wide_index::find( std::numeric_limits< uint64_t >::max() ), 0u );
+        EXPECT_EQ( wide_index::find( 0 ), 1u );
+        EXPECT_EQ( wide_index::find( 1 ), 2u );
+        EXPECT_EQ( wide_index::find( 2 ), wide_index::npos );
+
+        using wide_signed_index = protocol_key_index<
+            std::numeric_limits< int64_t >::min(),
+            std::numeric_limits< int64_t >::max() >;
+        EXPECT_EQ( wide_signed_index::find( std::numeric_limits< int64_t >::min() ), 0u );
+        EXPECT_EQ( wide_signed_index::find( std::numeric_limits< int64_t >::max() ), 1u );
+        EXPECT_EQ( wide_signed_index::find( 0 ), wide_signed_index::npos );
+}
+
+TEST( protocol_map, missing_key )
+{
+        test_map m;
+        auto     key = static_cast< test_keys >( 5 );
+        EXPECT_FALSE( m.contains( key ) );
+        EXPECT_TRUE( m.contains( SOO ) );
+
+        bool called = false;
+        m.with_register( key, [&]( const auto& ) {
+                called = true;
+        } );
+        EXPECT_FALSE( called );
+
+        std::array< uint8_t, 4 > data{ 1, 2, 3, 4 };
+        EXPECT_FALSE( test_handler::insert( m, key, view{ data } ) );
+        EXPECT_FALSE( test_handler::insert( m, WOO, view{ data } ) );
+        EXPECT_EQ( m.get_val< WOO >(), 0x01020304u );
+}
+
+using tracked_map     = protocol_tracked_register_map< test_map >;
+using tracked_handler = protocol_register_handler< tracked_map >;
+
+TEST( protocol_map, dirty_tracking )
+{
+        tracked_map m;
+        EXPECT_EQ( m.dirty_count(), 0u );
+
+        m.set_val< TOO >( 42 );
+        m.set_val< FOO >( 666 );
+        EXPECT_TRUE( m.is_dirty( TOO ) );
+        EXPECT_TRUE( m.is_dirty( FOO ) );
+        EXPECT_FALSE( m.is_dirty( WOO ) );
+        EXPECT_EQ( m.dirty_count(), 2u );
+
+        // registers are passed in order of the map and their bits are cleared
+        std::vector< test_keys > keys;
+        m.consume_dirty( [&]< typename reg_type >( const reg_type& ) {
+                keys.push_back( reg_type::key );
+        } );
+        EXPECT_EQ( keys, ( std::vector< test_keys >{ FOO, TOO } ) );
+        EXPECT_EQ( m.dirty_count(), 0u );
+
+        // setting the same value does not modify the register
+        m.set_val< TOO >( 42 );
+        EXPECT_FALSE( m.is_dirty( TOO ) );
+
+        // insert from the device modifies the register as well
+        std::array< uint8_t, 4 > data{ 0, 0, 0, 7 };
+        EXPECT_FALSE( tracked_handler::insert( m, WOO, view{ data } ) );
+        EXPECT_TRUE( m.is_dirty( WOO ) );
+        EXPECT_FALSE( tracked_handler::insert( m, WOO, view{ data } ) );
+        EXPECT_EQ( m.dirty_count(), 1u );
+
+        m.mark_all_dirty();
+        EXPECT_EQ( m.dirty_count(), test_map::registers_count );
+        m.clear_dirty();
+        EXPECT_EQ( m.dirty_count(), 0u );
+
+        // block insert goes through the tracking setters as well
+        std::array< uint8_t, 5 > block{ 0, 0, 0, 8, 3 };
+        EXPECT_FALSE( tracked_handler::insert_range( m, WOO, view{ block } ) );
+        EXPECT_TRUE( m.is_dirty( WOO ) );
+        EXPECT_TRUE( m.is_dirty( TOO ) );
+        EXPECT_EQ( m.dirty_count(), 2u );
+}
+
+// The wrapped map is reachable only for reading, so no write can bypass the dirty bits
+TEST( protocol_map, tracked_wraps_map )
+{
+        static_assert( !std::is_convertible_v< tracked_map&, test_map& > );
+        static_assert( std::is_same_v<
+                       decltype( std::declval< tracked_map& >().map() ),
+                       const test_map& > );
+
+        test_map init;
+        init.set_val< FOO >( 42 );
+        tracked_map m{ init };
+        EXPECT_EQ( m.get_val< FOO >(), 42u );
+        EXPECT_EQ( m.map().get_val< FOO >(), 42u );
+        EXPECT_EQ( m.dirty_count(), 0u );
+
+        m.set_val< FOO >( 43 );
+        EXPECT_EQ( m.map().get_val< FOO >(), 43u );
+        EXPECT_TRUE( m.is_dirty( FOO ) );
+}
+
+TEST( protocol_map, delta )
+{
+        tracked_map source;
+        source.set_val< WOO >( 0x01020304 );
+        source.set_val< SOO >( bounded< uint8_t, 2, 4 >::get< 3 >() );
+
+        auto msg = tracked_handler::serialize_delta( source );
+        EXPECT_EQ( msg.size(), 2 * tracked_handler::key_size + 4 + 1 );
+        EXPECT_EQ( source.dirty_count(), 0u );
+
+        tracked_map target;
+        EXPECT_FALSE( tracked_handler::insert_delta( target, msg ) );
+        EXPECT_EQ( target.get_val< WOO >(), 0x01020304u );
+        EXPECT_EQ( target.get_val< SOO >(), ( bounded< uint8_t, 2, 4 >::get< 3 >() ) );
+        EXPECT_EQ( target.dirty_count(), 2u );
+
+        // nothing changed, delta is empty
+        EXPECT_EQ( tracked_handler::serialize_delta( source ).size(), 0u );
+
+        // registers that do not fit into the buffer stay modified
+        source.set_val< FOO >( 1 );
+        source.set_val< KOO >( 50 );
+        std::array< uint8_t, tracked_handler::key_size + 4 > buffer;
+        EXPECT_EQ( tracked_handler::serialize_delta_into( source, buffer ), buffer.size() );
+        EXPECT_FALSE( source.is_dirty( FOO ) );
+        EXPECT_TRUE( source.is_dirty( KOO ) );
+
+        // record with unknown key is rejected
+        std::vector< uint8_t > bad( msg.begin(), msg.end() );
+        bad[tracked_handler::key_size - 1] = 5;
+        auto err = tracked_handler::insert_delta( target, view_n( bad.data(), bad.size() ) );
+        ASSERT_TRUE( err );
+        EXPECT_EQ( err->mark, UNDEFKEY_ERR );
+        EXPECT_EQ( err->offset, 0u );
+
+        // truncated value of the last record
+        auto short_err =
+            tracked_handler::insert_delta( target, view_n( msg.begin(), msg.size() - 1 ) );
+        ASSERT_TRUE( short_err );
+        EXPECT_EQ( short_err->offset, tracked_handler::key_size + 4 + tracked_handler::key_size );
+}
+
+TEST( protocol_map, range )
+{
+        EXPECT_EQ( test_handler::range_max_size, 4 + 4 + 1 + 1 + 4 );
+
+        test_map source;
+        source.set_val< WOO >( 0x01020304 );
+        source.set_val< TOO >( 42 );
+        source.set_val< SOO >( bounded< uint8_t, 2, 4 >::get< 3 >() );
+
+        auto opt_msg = test_handler::select_range( source, WOO, SOO );
+        ASSERT_TRUE( opt_msg );
+        std::vector< uint8_t > expected = { 0x01, 0x02, 0x03, 0x04, 42, 3 };
+        EXPECT_EQ( std::vector< uint8_t >( opt_msg->begin(), opt_msg->end() ), expected );
+
+        test_map target;
+        EXPECT_FALSE( test_handler::insert_range( target, WOO, *opt_msg ) );
+        EXPECT_EQ( target.get_val< WOO >(), 0x01020304u );
+        EXPECT_EQ( target.get_val< TOO >(), 42u );
+        EXPECT_EQ( target.get_val< SOO >(), ( bounded< uint8_t, 2, 4 >::get< 3 >() ) );
+
+        // block of registers has to fit into the buffer
+        std::array< uint8_t, 5 > small;
+        EXPECT_FALSE( test_handler::select_range_into( source, WOO, SOO, small ) );
+        EXPECT_EQ( test_handler::select_range_into( source, WOO, TOO, small ), 5u );
+
+        // keys out of order or not in the map
+        EXPECT_FALSE( test_handler::select_range( source, SOO, WOO ) );
+        auto missing = static_cast< test_keys >( 5 );
+        EXPECT_FALSE( test_handler::select_range( source, WOO, missing ) );
+        auto undef_err = test_handler::insert_range( target, missing, *opt_msg );
+        ASSERT_TRUE( undef_err );
+        EXPECT_EQ( undef_err->mark, UNDEFKEY_ERR );
+
+        // block longer than the rest of the map
+        auto big_err = test_handler::insert_range( target, KOO, *opt_msg );
+        ASSERT_TRUE( big_err );
+        EXPECT_EQ( big_err->mark, BIGSIZE_ERR );
+        EXPECT_EQ( big_err->offset, 4u );
+
+        // truncated value of the last register
+        auto short_err =
+            test_handler::insert_range( target, FOO, view_n( opt_msg->begin(), 6 ) );
+        ASSERT_TRUE( short_err );
+        EXPECT_EQ( short_err->offset, 4u );
+
+        // value out of bounds of the register, registers before it are inserted
+        expected[5] = 7;
+        test_map bad_target;
+        auto     bound_err = test_handler::insert_range(
+            bad_target, WOO, view_n( expected.data(), expected.size() ) );
+        ASSERT_TRUE( bound_err );
+        EXPECT_EQ( bound_err->offset, 5u );
+        EXPECT_EQ( bad_target.get_val< TOO >(), 42u );
+}
+
 int main( int argc, char** argv )
 {
         testing::InitGoogleTest( &argc, argv );
@@ -23,6 +23,9 @@ struct sequencer_def
 
 using sequencer = protocol_sequencer< sequencer_def >;
 
+// sequencer without checksum and view support keeps no state besides its buffer
+static_assert( sizeof( sequencer ) == sizeof( static_circular_buffer< uint8_t, 32 > ) );
+
 TEST( protocol_seq, basic )
 {
         std::array< uint8_t, 6 > data = { 0x44, 0x44, 0x03, 0x02, 0x03, 0xe8 };
@@ -105,3 +108,213 @@ TEST( protocol_seq, multi_msg )
                         EXPECT_TRUE( are_equal );
                 } );
 }
+
+TEST( protocol_seq, long_noise )
+{
+        std::vector< uint8_t > data( 20, 0x32 );
+        data[7] = 0x44;
+        data.insert( data.end(), { 0x44, 0x44, 0x01, 0x42 } );
+
+        sequencer seq;
+
+        // the noise is loaded in chunks so that the internal buffer wraps around
+        std::optional< protocol_message< 16 > > res;
+        for ( std::size_t i = 0; i < data.size(); i += 6 ) {
+                std::size_t n = std::min< std::size_t >( 6, data.size() - i );
+                seq.load_data( view_n( data.data() + i, n ) )
+                    .match(
+                        [&]( std::size_t to_read ) {
+                                EXPECT_GT( to_read, 0u );
+                        },
+                        [&]( auto msg ) {
+                                res = msg;
+                        } );
+        }
+
+        ASSERT_TRUE( res );
+        bool are_equal = equal( *res, view_n( data.end() - 4, 4 ) );
+        EXPECT_TRUE( are_equal ) << *res;
+}
+
+TEST( protocol_seq, drain_burst )
+{
+        // more messages than fit into the internal buffer at once
+        std::vector< uint8_t > data{ 0x32 };
+        for ( uint8_t i = 0; i < 10; i++ ) {
+                data.insert( data.end(), { 0x44, 0x44, 0x02, i, 0x32 } );
+        }
+        data.insert( data.end(), { 0x44, 0x44 } );
+
+        sequencer                                  seq;
+        std::vector< protocol_message< 16 > > msgs;
+
+        std::size_t to_read = seq.load_data( view{ data }, [&]( const auto& msg ) {
+                msgs.push_back( msg );
+        } );
+
+        EXPECT_EQ( to_read, 1u );
+        ASSERT_EQ( msgs.size(), 10u );
+        for ( uint8_t i = 0; i < 10; i++ ) {
+                EXPECT_EQ( msgs[i], ( protocol_message< 16 >{ 0x44, 0x44, 0x02, i, 0x32 } ) );
+        }
+}
+
+TEST( protocol_seq, invalid_size )
+{
+        // size of the first message is bigger than the maximal size of message
+        std::array< uint8_t, 8 > data = { 0x44, 0x44, 0xff, 0x44, 0x44, 0x01, 0x42 };
+
+        sequencer seq;
+
+        std::vector< protocol_message< 16 > > msgs;
+        seq.load_data( view_n( data.begin(), 7 ), [&]( const auto& msg ) {
+                msgs.push_back( msg );
+        } );
+
+        ASSERT_EQ( msgs.size(), 1u );
+        EXPECT_EQ( msgs[0], ( protocol_message< 16 >{ 0x44, 0x44, 0x01, 0x42 } ) );
+}
+
+// Definition whose size field contains size of whole message
+struct total_size_def
+{
+        using message_type = protocol_message< 16 >;
+
+        static constexpr std::array< uint8_t, 2 > prefix     = { 0x44, 0x44 };
+        static constexpr std::size_t              fixed_size = 3;
+
+        static constexpr std::size_t get_size( const auto& bview )
+        {
+                return bview[2];
+        }
+};
+
+TEST( protocol_seq, short_size )
+{
+        // size fields of the first two messages are smaller than the fixed part of message
+        std::array< uint8_t, 10 > data = {
+            0x44, 0x44, 0x00, 0x44, 0x44, 0x02, 0x44, 0x44, 0x04, 0x42 };
+
+        protocol_sequencer< total_size_def >  seq;
+        std::vector< protocol_message< 16 > > msgs;
+        std::size_t                           to_read = seq.load_data( view{ data }, [&]( const auto& msg ) {
+                msgs.push_back( msg );
+        } );
+
+        EXPECT_EQ( to_read, 3u );
+        ASSERT_EQ( msgs.size(), 1u );
+        EXPECT_EQ( msgs[0], ( protocol_message< 16 >{ 0x44, 0x44, 0x04, 0x42 } ) );
+
+        protocol_view_sequencer< total_size_def > vseq;
+        std::size_t                               vcount = 0;
+        vseq.load_view( view{ data }, [&]( view< const uint8_t* > msg ) {
+                EXPECT_EQ( msg.size(), 4u );
+                vcount += 1;
+        } );
+        EXPECT_EQ( vcount, 1u );
+}
+
+using view_sequencer = protocol_view_sequencer< sequencer_def >;
+
+TEST( protocol_seq, view_multi_msg )
+{
+        std::array< uint8_t, 10 > data = {
+            0x32, 0x44, 0x44, 0x01, 0x42, 0x4, 0x44, 0x44, 0x01, 0x34 };
+
+        auto msg1 = view_n( data.begin() + 1, 4 );
+        auto msg2 = view_n( data.begin() + 6, 4 );
+
+        view_sequencer seq;
+
+        seq.load_view( view_n( data.begin(), 3 ) )
+            .match(
+                [&]( std::size_t to_read ) {
+                        EXPECT_EQ( to_read, 1u );
+                },
+                [&]( auto ) {
+                        FAIL();
+                } );
+
+        seq.load_view( view_n( data.begin() + 3, 7 ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL();
+                },
+                [&]( view< const uint8_t* > msg ) {
+                        bool are_equal = equal( msg, msg1 );
+                        EXPECT_TRUE( are_equal );
+                } );
+
+        // second message is already in the buffer, loading no data releases the first one
+        seq.load_view( view_n( data.begin(), 0 ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL();
+                },
+                [&]( view< const uint8_t* > msg ) {
+                        bool are_equal = equal( msg, msg2 );
+                        EXPECT_TRUE( are_equal );
+                } );
+
+        seq.release();
+        seq.load_view( view_n( data.begin(), 0 ) )
+            .match(
+                [&]( std::size_t to_read ) {
+                        EXPECT_EQ( to_read, 3u );
+                },
+                [&]( auto ) {
+                        FAIL();
+                } );
+}
+
+TEST( protocol_seq, view_drain_burst )
+{
+        std::vector< uint8_t > data{ 0x32 };
+        for ( uint8_t i = 0; i < 10; i++ ) {
+                data.insert( data.end(), { 0x44, 0x44, 0x02, i, 0x32 } );
+        }
+        data.insert( data.end(), { 0x44, 0x44 } );
+
+        view_sequencer                        seq;
+        std::vector< protocol_message< 16 > > msgs;
+
+        std::size_t to_read = seq.load_view( view{ data }, [&]( view< const uint8_t* > msg ) {
+                auto opt_msg = protocol_message< 16 >::make( msg );
+                ASSERT_TRUE( opt_msg );
+                msgs.push_back( *opt_msg );
+        } );
+
+        EXPECT_EQ( to_read, 1u );
+        ASSERT_EQ( msgs.size(), 10u );
+        for ( uint8_t i = 0; i < 10; i++ ) {
+                EXPECT_EQ( msgs[i], ( protocol_message< 16 >{ 0x44, 0x44, 0x02, i, 0x32 } ) );
+        }
+}
+
+TEST( protocol_seq, stats )
+{
+        using stats_sequencer =
+            protocol_sequencer< sequencer_def, protocol_linear_buffer< 32 >, protocol_stats<> >;
+        static_assert( sizeof( sequencer ) == sizeof( protocol_sequencer<
+                                                      sequencer_def,
+                                                      static_circular_buffer< uint8_t, 32 >,
+                                                      protocol_no_stats > ) );
+
+        // noise, message, message with invalid size, message
+        std::vector< uint8_t > data = {
+            0x32, 0x33, 0x44, 0x44, 0x01, 0x42, 0x44, 0x44, 0xff, 0x44, 0x44, 0x02, 0x01, 0x02 };
+
+        stats_sequencer seq;
+        std::size_t     count = 0;
+        seq.load_view( view{ data }, [&]( view< const uint8_t* > ) {
+                count += 1;
+        } );
+
+        auto snap = seq.stats().snapshot();
+        EXPECT_EQ( count, 2u );
+        EXPECT_EQ( snap.frames, 2u );
+        EXPECT_EQ( snap.bytes_loaded, data.size() );
+        EXPECT_EQ( snap.bytes_discarded, 5u );
+        EXPECT_EQ( snap.buffer_high_water, data.size() );
+        EXPECT_EQ( snap.checksum_failures, 0u );
+}
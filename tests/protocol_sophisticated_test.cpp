@@ -1,6 +1,7 @@
 
 #include "emlabcpp/iterators/convert.h"
 #include "emlabcpp/protocol/command_group.h"
+#include "emlabcpp/protocol/field_accessor.h"
 #include "emlabcpp/protocol/handler.h"
 #include "emlabcpp/protocol/json.h"
 #include "emlabcpp/protocol/streams.h"
@@ -85,6 +86,18 @@ struct valid_test_case : protocol_test_fixture
                     << "msg: " << convert_view< int >( msg ) << "\n"
                     << "expected: " << convert_view< int >( expected_buffer ) << "\n";
 
+                std::array< uint8_t, handler::def::max_size > buffer{};
+                std::optional< std::size_t > opt_used = handler::serialize_into( buffer, val );
+                ASSERT_TRUE( opt_used );
+                EXPECT_TRUE( equal( view_n( buffer.begin(), *opt_used ), expected_buffer ) );
+
+                std::vector< uint8_t > out;
+                handler::serialize_into( std::back_inserter( out ), val );
+                EXPECT_EQ( out, expected_buffer );
+
+                EXPECT_FALSE( handler::serialize_into(
+                    std::span< uint8_t >( buffer ).first( handler::def::max_size - 1 ), val ) );
+
                 handler::extract( msg ).match(
                     [&]( auto var ) {
                             EXPECT_EQ( var, val );
@@ -110,6 +123,172 @@ make_valid_test_case( typename Group::value_type val, const std::vector< uint8_t
         };
 }
 
+TEST( protocol_field_accessor, get_set )
+{
+        using handler  = protocol_handler< test_tuple >;
+        using accessor = protocol_field_accessor< test_tuple >;
+
+        static_assert( accessor::offset< 0 > == 0 );
+        static_assert( accessor::offset< 1 > == 4 );
+        static_assert( accessor::offset< 3 > == 8 );
+
+        auto msg = handler::serialize(
+            test_tuple::make_val( 23657453, 666, std::bitset< 13 >{ 42 }, 6634343 ) );
+
+        accessor::get< 1 >( msg ).match(
+            [&]( uint16_t val ) {
+                    EXPECT_EQ( val, 666 );
+            },
+            [&]( protocol_error_record rec ) {
+                    FAIL() << rec;
+            } );
+
+        EXPECT_FALSE( accessor::set< 3 >( msg, 42u ) );
+        EXPECT_FALSE( accessor::set< 2 >( msg, std::bitset< 13 >{ 7 } ) );
+
+        handler::extract( msg ).match(
+            [&]( auto val ) {
+                    EXPECT_EQ(
+                        val, test_tuple::make_val( 23657453, 666, std::bitset< 13 >{ 7 }, 42 ) );
+            },
+            [&]( protocol_error_record rec ) {
+                    FAIL() << rec;
+            } );
+
+        auto short_msg = *test_tuple::message_type::make( view_n( msg.begin(), 6 ) );
+        EXPECT_FALSE( accessor::get< 3 >( short_msg ).is_left() );
+        EXPECT_TRUE( accessor::set< 3 >( short_msg, 42u ) );
+}
+
+TEST( protocol_command_group, tag_dispatch )
+{
+        using handler = protocol_handler< complex_group >;
+
+        static_assert( protocol_tag_led_group<
+                       typename protocol_command< FOO >::def_type,
+                       typename protocol_command< WOO >::with_args< uint8_t >::def_type > );
+        static_assert( !protocol_tag_led_group< uint32_t, uint8_t > );
+        // group of such definitions with duplicate ids is refused by static_assert
+        static_assert( !protocol_key_index< FOO, WOO, FOO >::has_unique_keys() );
+        static_assert( protocol_key_index< FOO, WOO >::has_unique_keys() );
+
+        std::array< uint8_t, 6 > unknown_id{ 0, 2, 0, 0, 0, 0 };
+        handler::extract( view_n( unknown_id.data(), unknown_id.size() ) )
+            .match(
+                [&]( auto ) {
+                        FAIL() << "unknown id should not be deserialized";
+                },
+                [&]( protocol_error_record rec ) {
+                        EXPECT_EQ( rec.mark, GROUP_ERR );
+                        EXPECT_EQ( rec.offset, 0u );
+                } );
+
+        // id of CD with missing arguments
+        std::array< uint8_t, 3 > missing_args{ 0, 9, 0 };
+        handler::extract( view_n( missing_args.data(), missing_args.size() ) )
+            .match(
+                [&]( auto ) {
+                        FAIL() << "incomplete command should not be deserialized";
+                },
+                [&]( protocol_error_record rec ) {
+                        EXPECT_EQ( rec.mark, GROUP_ERR );
+                } );
+}
+
+TEST( protocol_handler, batch )
+{
+        using tuple_handler = protocol_handler< test_tuple >;
+
+        std::vector< test_tuple::value_type > tuple_vals{
+            test_tuple::make_val( 1, 2, std::bitset< 13 >{ 3 }, 4 ),
+            test_tuple::make_val( 23657453, 666, std::bitset< 13 >{ 42 }, 6634343 ),
+            test_tuple::make_val( 5, 6, std::bitset< 13 >{ 7 }, 8 ) };
+
+        std::vector< uint8_t > buffer;
+        tuple_handler::serialize_many( tuple_vals, std::back_inserter( buffer ) );
+        EXPECT_EQ( buffer.size(), 3 * tuple_handler::def::max_size );
+
+        std::vector< test_tuple::value_type > tuple_res;
+        tuple_handler::extract_many( buffer, std::back_inserter( tuple_res ) )
+            .match(
+                [&]( std::size_t count ) {
+                        EXPECT_EQ( count, 3u );
+                },
+                [&]( protocol_batch_error_record rec ) {
+                        FAIL() << rec;
+                } );
+        EXPECT_EQ( tuple_res, tuple_vals );
+
+        // complete records are extracted before the incomplete one at the end is reported
+        std::vector< uint8_t > extended = buffer;
+        extended.push_back( 0 );
+        extended.push_back( 0 );
+        tuple_res.clear();
+        tuple_handler::extract_many( extended, std::back_inserter( tuple_res ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL() << "incomplete buffer should not be extracted";
+                },
+                [&]( protocol_batch_error_record rec ) {
+                        EXPECT_EQ( rec.rec.mark, SIZE_ERR );
+                        EXPECT_EQ( rec.rec.offset, 2u );
+                        EXPECT_EQ( rec.index, 3u );
+                } );
+        EXPECT_EQ( tuple_res, tuple_vals );
+
+        buffer.pop_back();
+        tuple_res.clear();
+        tuple_handler::extract_many( buffer, std::back_inserter( tuple_res ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL() << "incomplete buffer should not be extracted";
+                },
+                [&]( protocol_batch_error_record rec ) {
+                        EXPECT_EQ( rec.rec.mark, SIZE_ERR );
+                        EXPECT_EQ( rec.rec.offset, tuple_handler::def::max_size - 1 );
+                        EXPECT_EQ( rec.index, 2u );
+                } );
+        ASSERT_EQ( tuple_res.size(), 2u );
+        EXPECT_EQ( tuple_res[0], tuple_vals[0] );
+        EXPECT_EQ( tuple_res[1], tuple_vals[1] );
+
+        using group_handler = protocol_handler< complex_group >;
+
+        std::vector< complex_group::value_type > group_vals{
+            complex_group::make_val< CB >(),
+            complex_group::make_val< CJ >( static_cast< uint32_t >( 666 ) ),
+            complex_group::make_val< CA >( -1 ),
+            complex_group::make_val< CJ >( static_cast< uint8_t >( 42 ) ) };
+
+        buffer.clear();
+        group_handler::serialize_many( group_vals, std::back_inserter( buffer ) );
+
+        std::vector< complex_group::value_type > group_res;
+        group_handler::extract_many( buffer, std::back_inserter( group_res ) )
+            .match(
+                [&]( std::size_t count ) {
+                        EXPECT_EQ( count, 4u );
+                },
+                [&]( protocol_batch_error_record rec ) {
+                        FAIL() << rec;
+                } );
+        EXPECT_EQ( group_res, group_vals );
+
+        // corrupt id of the third record
+        buffer[9] = 2;
+        group_res.clear();
+        group_handler::extract_many( buffer, std::back_inserter( group_res ) )
+            .match(
+                [&]( std::size_t ) {
+                        FAIL() << "corrupted record should not be extracted";
+                },
+                [&]( protocol_batch_error_record rec ) {
+                        EXPECT_EQ( rec.rec.mark, GROUP_ERR );
+                        EXPECT_EQ( rec.index, 2u );
+                } );
+        EXPECT_EQ( group_res.size(), 2u );
+}
+
 int main( int argc, char** argv )
 {
         testing::InitGoogleTest( &argc, argv );
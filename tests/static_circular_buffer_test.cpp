@@ -34,6 +34,47 @@ TEST( static_circular_buffer_test, pop_front )
         EXPECT_EQ( obuff.front(), "Yes" );
 }
 
+TEST( static_circular_buffer_test, bulk_pop_front )
+{
+        trivial_buffer tbuff;
+        obj_buffer     obuff;
+
+        for ( int i : { 1, 2, 3, 4, 5 } ) {
+                tbuff.push_back( i );
+                obuff.push_back( std::to_string( i ) );
+        }
+
+        tbuff.pop_front( 3 );
+        obuff.pop_front( 3 );
+        EXPECT_EQ( tbuff.size(), 2 );
+        EXPECT_EQ( tbuff.front(), 4 );
+        EXPECT_EQ( obuff.size(), 2 );
+        EXPECT_EQ( obuff.front(), "4" );
+}
+
+TEST( static_circular_buffer_test, segments )
+{
+        trivial_buffer tbuff;
+
+        for ( int i : { 1, 2, 3, 4, 5 } ) {
+                tbuff.push_back( i );
+        }
+        auto [first, second] = tbuff.segments();
+        EXPECT_EQ(
+            std::vector< int >( first.begin(), first.end() ), ( std::vector{ 1, 2, 3, 4, 5 } ) );
+        EXPECT_TRUE( second.empty() );
+
+        // items 8 and 9 wrap around the end of the storage
+        tbuff.pop_front( 4 );
+        for ( int i : { 6, 7, 8, 9 } ) {
+                tbuff.push_back( i );
+        }
+        auto [wfirst, wsecond] = tbuff.segments();
+        EXPECT_EQ(
+            std::vector< int >( wfirst.begin(), wfirst.end() ), ( std::vector{ 5, 6, 7, 8 } ) );
+        EXPECT_EQ( std::vector< int >( wsecond.begin(), wsecond.end() ), ( std::vector{ 9 } ) );
+}
+
 TEST( static_circular_buffer_test, push_back )
 {
         trivial_buffer tbuff;